@@ -0,0 +1,41 @@
+#include "myx_coroutine/lib.h"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <span>
+
+namespace myx_coroutine {
+namespace {
+    // One resume and one suspend per element.
+    void BM_GeneratorCountTo(benchmark::State &state) {
+        const int n = static_cast<int>(state.range(0));
+        for (auto _ : state) {
+            std::int64_t sum = 0;
+            for (int value : count_to(n)) {
+                sum += value;
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+    BENCHMARK(BM_GeneratorCountTo)->RangeMultiplier(16)->Range(16, 1 << 16);
+
+    // The same sequence a chunk per resume, for comparison.
+    void BM_ChunkedGeneratorCountTo(benchmark::State &state) {
+        const int n = static_cast<int>(state.range(0));
+        std::array<int, 1024> buffer;
+        for (auto _ : state) {
+            std::int64_t sum = 0;
+            auto gen = count_to_chunked(n);
+            for (std::span<const int> chunk : gen.chunks(buffer)) {
+                for (int value : chunk) {
+                    sum += value;
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+    BENCHMARK(BM_ChunkedGeneratorCountTo)->RangeMultiplier(16)->Range(16, 1 << 16);
+} // namespace
+} // namespace myx_coroutine
@@ -0,0 +1,52 @@
+#include "myx_coroutine/promise.hpp"
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <thread>
+#include <utility>
+
+namespace myx_coroutine {
+namespace {
+    // Fulfilled and read on the same thread: the cost of the shared state itself.
+    void BM_PromiseFutureSameThread(benchmark::State &state) {
+        int value = 0;
+        for (auto _ : state) {
+            Promise<int> promise;
+            auto future = promise.get_future();
+            promise.set_value(++value);
+            benchmark::DoNotOptimize(future.get());
+        }
+    }
+    BENCHMARK(BM_PromiseFutureSameThread);
+
+    // `set_value` on another thread until `get` returns here: the wake-up latency. The
+    // promise is handed over by move, the responder owns it while fulfilling it.
+    void BM_PromiseFutureRoundTrip(benchmark::State &state) {
+        Promise<int> handoff;
+        std::atomic<bool> pending{false};
+        std::atomic<bool> done{false};
+        std::thread responder([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                if (!pending.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                Promise<int> promise = std::move(handoff);
+                pending.store(false, std::memory_order_relaxed);
+                // Orders the two stores above before the requester's next handoff.
+                promise.set_value(1);
+            }
+        });
+
+        for (auto _ : state) {
+            Promise<int> promise;
+            auto future = promise.get_future();
+            handoff = std::move(promise);
+            pending.store(true, std::memory_order_release);
+            benchmark::DoNotOptimize(future.get());
+        }
+        done.store(true, std::memory_order_release);
+        responder.join();
+    }
+    BENCHMARK(BM_PromiseFutureRoundTrip)->UseRealTime();
+} // namespace
+} // namespace myx_coroutine
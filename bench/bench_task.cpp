@@ -0,0 +1,48 @@
+#include "myx_coroutine/task.hpp"
+#include <benchmark/benchmark.h>
+
+namespace myx_coroutine {
+namespace {
+    Task<int> leaf() {
+        co_return 1;
+    }
+
+    Task<int> chain(int depth) {
+        if (depth == 0) {
+            co_return 0;
+        }
+        co_return co_await chain(depth - 1) + 1;
+    }
+
+    // Allocating the frame, running it to completion and freeing it.
+    void BM_TaskCreateResumeDestroy(benchmark::State &state) {
+        for (auto _ : state) {
+            auto task = leaf();
+            task.resume();
+            benchmark::DoNotOptimize(task.promise().get_result());
+        }
+    }
+    BENCHMARK(BM_TaskCreateResumeDestroy);
+
+    // Frame allocation alone, the task is destroyed without ever running.
+    void BM_TaskCreateDestroy(benchmark::State &state) {
+        for (auto _ : state) {
+            auto task = leaf();
+            benchmark::DoNotOptimize(task);
+        }
+    }
+    BENCHMARK(BM_TaskCreateDestroy);
+
+    // Each level awaits the next one: one frame, one symmetric transfer in and one out.
+    void BM_TaskChain(benchmark::State &state) {
+        const int depth = static_cast<int>(state.range(0));
+        for (auto _ : state) {
+            auto task = chain(depth);
+            task.resume();
+            benchmark::DoNotOptimize(task.promise().get_result());
+        }
+        state.SetItemsProcessed(state.iterations() * depth);
+    }
+    BENCHMARK(BM_TaskChain)->RangeMultiplier(4)->Range(1, 1024);
+} // namespace
+} // namespace myx_coroutine
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace myx_coroutine {
+
+/// Log-linear histogram of nanosecond latencies in the style of HdrHistogram: values below
+/// 2^kSubBits are counted exactly, above that every power of two is split into 2^(kSubBits-1)
+/// equal buckets, so any recorded value is known to within 1/128 of itself. Recording is an
+/// index computation and an increment, one histogram per thread and `merge` them afterwards.
+class LatencyHistogram {
+  public:
+    static constexpr unsigned kSubBits = 8;
+
+    void record(std::uint64_t value) noexcept {
+        ++counts_[index_of(value)];
+        ++total_;
+        if (value > max_) {
+            max_ = value;
+        }
+    }
+
+    void merge(const LatencyHistogram &other) noexcept {
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        if (other.max_ > max_) {
+            max_ = other.max_;
+        }
+    }
+
+    std::uint64_t count() const noexcept { return total_; }
+
+    std::uint64_t max() const noexcept { return max_; }
+
+    /// Smallest value at or below which `fraction` of the recorded values lie, reported as the
+    /// upper end of its bucket, never above the maximum.
+    std::uint64_t percentile(double fraction) const noexcept {
+        if (total_ == 0) {
+            return 0;
+        }
+        auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(total_));
+        rank = rank == 0 ? 1 : rank;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                std::uint64_t upper = lower_bound_of(i + 1) - 1;
+                return upper < max_ ? upper : max_;
+            }
+        }
+        return max_;
+    }
+
+  private:
+    static constexpr std::uint64_t kExact = std::uint64_t{1} << kSubBits;
+    static constexpr std::uint64_t kHalf = kExact / 2;
+    static constexpr std::size_t kBuckets = kExact + (64 - kSubBits) * kHalf;
+
+    // Above the exact range, a value of bit width `w` is shifted right by `w - kSubBits`,
+    // which leaves a mantissa in [kHalf, kExact).
+    static std::size_t index_of(std::uint64_t value) noexcept {
+        if (value < kExact) {
+            return static_cast<std::size_t>(value);
+        }
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - kSubBits;
+        std::uint64_t mantissa = value >> shift;
+        return static_cast<std::size_t>(kExact + (shift - 1) * kHalf + (mantissa - kHalf));
+    }
+
+    static std::uint64_t lower_bound_of(std::size_t index) noexcept {
+        if (index < kExact) {
+            return index;
+        }
+        std::size_t shift = (index - kExact) / kHalf + 1;
+        std::uint64_t mantissa = kHalf + (index - kExact) % kHalf;
+        if (shift >= 64 - kSubBits + 1) {
+            return UINT64_MAX;
+        }
+        return mantissa << shift;
+    }
+
+    std::array<std::uint64_t, kBuckets> counts_{};
+    std::uint64_t total_ = 0;
+    std::uint64_t max_ = 0;
+};
+} // namespace myx_coroutine
@@ -0,0 +1,326 @@
+// Thread scaling of ThreadPool::push_task and of ConcurrentQueue handoff.
+//
+//     myx_coroutine_scaling [--threads N] [--ops N] [--window N] [--payloads 8,64,512] [--csv]
+//
+// For 1, 2, 4, ... up to N threads (N defaults to the hardware concurrency) and every payload
+// size, prints the throughput and the p50/p99/p999/max latency from enqueue to execution:
+//
+// - pool/<scheduling>: the main thread pushes `ops` tasks capturing `payload` bytes into a
+//   ThreadPool with that many workers, in both scheduling modes. The payload comes with 32
+//   bytes of bookkeeping. In shared-queue mode, above 16 bytes the task no longer fits
+//   SmallFunction's inline buffer and costs an allocation. Work-stealing mode allocates one
+//   node per task whatever the payload, so its rows show no such step.
+// - queue: as many producers as consumers share one ConcurrentQueue of `payload`-sized items.
+//
+// At most `window` items are in flight at a time, so the latency is measured under a steady
+// load rather than behind an ever growing backlog.
+#include "latency_histogram.hpp"
+#include "myx_coroutine/concurrent_queue.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace myx_coroutine {
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using coroutine::ConcurrentQueue;
+    using coroutine::ThreadPool;
+
+    struct Options {
+        std::size_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+        std::size_t ops = 200'000;
+        std::size_t window = 1024;
+        std::vector<std::size_t> payloads{8, 64, 512};
+        bool csv = false;
+    };
+
+    struct Result {
+        const char *name_;
+        std::size_t threads_;
+        std::size_t payload_;
+        std::size_t ops_;
+        double seconds_;
+        LatencyHistogram latency_;
+    };
+
+    std::uint64_t nanoseconds_since(Clock::time_point start) noexcept {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()
+        );
+    }
+
+    // One histogram per recording thread, merged once the run is over. Threads are new for
+    // every run, the thread-local cache is keyed by the recorder.
+    class Recorder {
+      public:
+        void record(Clock::time_point enqueued) { local().record(nanoseconds_since(enqueued)); }
+
+        LatencyHistogram merged() {
+            std::lock_guard lock(mtx_);
+            LatencyHistogram result;
+            for (auto &histogram : histograms_) {
+                result.merge(*histogram);
+            }
+            return result;
+        }
+
+      private:
+        LatencyHistogram &local() {
+            thread_local const Recorder *owner = nullptr;
+            thread_local LatencyHistogram *histogram = nullptr;
+            if (owner != this) {
+                std::lock_guard lock(mtx_);
+                histograms_.push_back(std::make_unique<LatencyHistogram>());
+                histogram = histograms_.back().get();
+                owner = this;
+            }
+            return *histogram;
+        }
+
+        std::mutex mtx_;
+        std::vector<std::unique_ptr<LatencyHistogram>> histograms_;
+    };
+
+    // Bounds the items in flight: producers acquire a slot, consumers release it.
+    class Window {
+      public:
+        explicit Window(std::size_t size) noexcept : free_(size) {}
+
+        void acquire() noexcept {
+            std::size_t free = free_.load(std::memory_order_relaxed);
+            while (true) {
+                if (free == 0) {
+                    std::this_thread::yield();
+                    free = free_.load(std::memory_order_relaxed);
+                } else if (free_.compare_exchange_weak(free, free - 1, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+        }
+
+        void release() noexcept { free_.fetch_add(1, std::memory_order_relaxed); }
+
+      private:
+        std::atomic<std::size_t> free_;
+    };
+
+    template<std::size_t Payload>
+    struct Item {
+        Clock::time_point enqueued_;
+        std::array<std::byte, Payload> payload_{};
+    };
+
+    // Keeps the payload from being optimised away.
+    thread_local unsigned sink = 0;
+
+    template<std::size_t Payload>
+    Result run_pool(
+        ThreadPool::Scheduling scheduling,
+        std::size_t threads,
+        const Options &options
+    ) {
+        Recorder recorder;
+        Window window(options.window);
+        std::atomic<std::size_t> remaining{options.ops};
+        Clock::time_point start;
+        double seconds = 0;
+        {
+            ThreadPool pool(threads, scheduling);
+            start = Clock::now();
+            for (std::size_t i = 0; i < options.ops; ++i) {
+                window.acquire();
+                Item<Payload> item{Clock::now()};
+                pool.push_task([item, &recorder, &window, &remaining] {
+                    recorder.record(item.enqueued_);
+                    sink += static_cast<unsigned>(item.payload_[Payload - 1]);
+                    window.release();
+                    remaining.fetch_sub(1, std::memory_order_release);
+                });
+            }
+            while (remaining.load(std::memory_order_acquire) != 0) {
+                std::this_thread::yield();
+            }
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        const char *name = scheduling == ThreadPool::Scheduling::WorkStealing
+                               ? "pool/work-stealing"
+                               : "pool/shared-queue";
+        return Result{name, threads, Payload, options.ops, seconds, recorder.merged()};
+    }
+
+    template<std::size_t Payload>
+    Result run_queue(std::size_t threads, const Options &options) {
+        Recorder recorder;
+        Window window(options.window);
+        ConcurrentQueue<Item<Payload>> queue;
+        std::size_t per_producer = options.ops / threads;
+        std::atomic<std::size_t> remaining{per_producer * threads};
+
+        auto start = Clock::now();
+        std::vector<std::jthread> workers;
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([&] {
+                for (std::size_t n = 0; n < per_producer; ++n) {
+                    window.acquire();
+                    queue.push(Item<Payload>{Clock::now()});
+                }
+            });
+            workers.emplace_back([&] {
+                Item<Payload> item;
+                while (queue.pop(item)) {
+                    recorder.record(item.enqueued_);
+                    sink += static_cast<unsigned>(item.payload_[Payload - 1]);
+                    window.release();
+                    remaining.fetch_sub(1, std::memory_order_release);
+                }
+            });
+        }
+        while (remaining.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        queue.stop();
+        workers.clear();
+        return Result{
+            "queue", threads, Payload, per_producer * threads, seconds, recorder.merged()
+        };
+    }
+
+    void print_header(const Options &options) {
+        if (options.csv) {
+            std::printf("benchmark,threads,payload_bytes,ops,seconds,ops_per_sec,"
+                        "p50_ns,p99_ns,p999_ns,max_ns\n");
+        } else {
+            std::printf(
+                "%-20s %7s %8s %10s %14s %10s %10s %10s %12s\n", "benchmark", "threads",
+                "payload", "ops", "ops/s", "p50 ns", "p99 ns", "p999 ns", "max ns"
+            );
+        }
+    }
+
+    void print(const Result &result, const Options &options) {
+        const LatencyHistogram &latency = result.latency_;
+        double rate = static_cast<double>(result.ops_) / result.seconds_;
+        auto p50 = static_cast<unsigned long long>(latency.percentile(0.50));
+        auto p99 = static_cast<unsigned long long>(latency.percentile(0.99));
+        auto p999 = static_cast<unsigned long long>(latency.percentile(0.999));
+        auto max = static_cast<unsigned long long>(latency.max());
+        if (options.csv) {
+            std::printf(
+                "%s,%zu,%zu,%zu,%.6f,%.0f,%llu,%llu,%llu,%llu\n", result.name_, result.threads_,
+                result.payload_, result.ops_, result.seconds_, rate, p50, p99, p999, max
+            );
+        } else {
+            std::printf(
+                "%-20s %7zu %8zu %10zu %14.0f %10llu %10llu %10llu %12llu\n", result.name_,
+                result.threads_, result.payload_, result.ops_, rate, p50, p99, p999, max
+            );
+        }
+        std::fflush(stdout);
+    }
+
+    template<std::size_t Payload>
+    void run_all(std::size_t threads, const Options &options) {
+        print(run_pool<Payload>(ThreadPool::Scheduling::SharedQueue, threads, options), options);
+        print(run_pool<Payload>(ThreadPool::Scheduling::WorkStealing, threads, options), options);
+        print(run_queue<Payload>(threads, options), options);
+    }
+
+    // Payload sizes are template arguments, only these are available.
+    bool run_payload(std::size_t payload, std::size_t threads, const Options &options) {
+        switch (payload) {
+            case 8: run_all<8>(threads, options); return true;
+            case 16: run_all<16>(threads, options); return true;
+            case 32: run_all<32>(threads, options); return true;
+            case 64: run_all<64>(threads, options); return true;
+            case 128: run_all<128>(threads, options); return true;
+            case 256: run_all<256>(threads, options); return true;
+            case 512: run_all<512>(threads, options); return true;
+            case 1024: run_all<1024>(threads, options); return true;
+            default: return false;
+        }
+    }
+
+    std::vector<std::size_t> parse_list(const char *text) {
+        std::vector<std::size_t> values;
+        std::string list(text);
+        std::size_t begin = 0;
+        while (begin <= list.size()) {
+            std::size_t end = list.find(',', begin);
+            end = end == std::string::npos ? list.size() : end;
+            values.push_back(std::strtoull(list.c_str() + begin, nullptr, 10));
+            begin = end + 1;
+        }
+        return values;
+    }
+
+    bool parse(int argc, char **argv, Options &options) {
+        for (int i = 1; i < argc; ++i) {
+            const char *arg = argv[i];
+            const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (std::strcmp(arg, "--csv") == 0) {
+                options.csv = true;
+                continue;
+            }
+            if (value == nullptr) {
+                return false;
+            }
+            if (std::strcmp(arg, "--threads") == 0) {
+                options.max_threads = std::strtoull(value, nullptr, 10);
+            } else if (std::strcmp(arg, "--ops") == 0) {
+                options.ops = std::strtoull(value, nullptr, 10);
+            } else if (std::strcmp(arg, "--window") == 0) {
+                options.window = std::strtoull(value, nullptr, 10);
+            } else if (std::strcmp(arg, "--payloads") == 0) {
+                options.payloads = parse_list(value);
+            } else {
+                return false;
+            }
+            ++i;
+        }
+        return options.max_threads != 0 && options.ops != 0 && options.window != 0;
+    }
+} // namespace
+} // namespace myx_coroutine
+
+int main(int argc, char **argv) {
+    using namespace myx_coroutine;
+    Options options;
+    if (!parse(argc, argv, options)) {
+        std::fprintf(
+            stderr,
+            "usage: %s [--threads N] [--ops N] [--window N] [--payloads 8,64,512] [--csv]\n",
+            argv[0]
+        );
+        return 1;
+    }
+
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t threads = 1; threads < options.max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(options.max_threads);
+
+    print_header(options);
+    for (std::size_t threads : thread_counts) {
+        for (std::size_t payload : options.payloads) {
+            if (!run_payload(payload, threads, options)) {
+                std::fprintf(stderr, "unsupported payload size %zu\n", payload);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -7,16 +7,21 @@
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 //
+// Ported from completion handlers to myx_coroutine::Task through the Asio bridge.
+//
 
+#include "myx_coroutine/asio_bridge.hpp"
+#include "myx_coroutine/task.hpp"
 #include <asio.hpp>
 #include <ctime>
-#include <functional>
+#include <exception>
 #include <iostream>
-#include <memory>
 #include <string>
-#include <system_error>
+#include <utility>
 
 using asio::ip::tcp;
+using myx_coroutine::Task;
+using myx_coroutine::use_task;
 
 std::string make_daytime_string() {
     using namespace std; // For time_t, time and ctime;
@@ -24,69 +29,34 @@ std::string make_daytime_string() {
     return ctime(&now);
 }
 
-class tcp_connection : public std::enable_shared_from_this<tcp_connection> {
-  public:
-    typedef std::shared_ptr<tcp_connection> pointer;
-
-    static pointer create(asio::io_context &io_context) {
-        return pointer(new tcp_connection(io_context));
-    }
-
-    tcp::socket &socket() { return socket_; }
-
-    void start() {
-        message_ = make_daytime_string();
-
-        asio::async_write(
-            socket_, asio::buffer(message_),
-            std::bind(
-                &tcp_connection::handle_write, shared_from_this(), asio::placeholders::error,
-                asio::placeholders::bytes_transferred
-            )
-        );
-    }
-
-  private:
-    tcp_connection(asio::io_context &io_context) : socket_(io_context) {}
-
-    void handle_write(const std::error_code & /*error*/, size_t /*bytes_transferred*/) {}
-
-    tcp::socket socket_;
-    std::string message_;
-};
-
-class tcp_server {
-  public:
-    tcp_server(asio::io_context &io_context)
-        : io_context_(io_context)
-        , acceptor_(io_context, tcp::endpoint(tcp::v4(), 13)) {
-        start_accept();
+Task<> serve(tcp::socket socket) {
+    std::string message = make_daytime_string();
+    try {
+        co_await asio::async_write(socket, asio::buffer(message), use_task);
+    } catch (const std::exception &) {
+        // The client went away, nothing to do.
     }
+}
 
-  private:
-    void start_accept() {
-        tcp_connection::pointer new_connection = tcp_connection::create(io_context_);
-
-        // clang-format off
-        acceptor_.async_accept(
-            new_connection->socket(),
-            [this, new_connection](const std::error_code &error) {
-                if (!error) {
-                    new_connection->start();
-                }
-                start_accept();
-            }
-        );
+Task<> accept_loop(tcp::acceptor &acceptor) {
+    for (;;) {
+        tcp::socket socket = co_await acceptor.async_accept(use_task);
+        myx_coroutine::co_spawn(acceptor.get_executor(), serve(std::move(socket)));
     }
-
-    asio::io_context &io_context_;
-    tcp::acceptor acceptor_;
-};
+}
 
 int main() {
     try {
         asio::io_context io_context;
-        tcp_server server(io_context);
+        tcp::acceptor acceptor(io_context, tcp::endpoint(tcp::v4(), 13));
+        myx_coroutine::co_spawn(
+            io_context, accept_loop(acceptor),
+            [](std::exception_ptr e) {
+                if (e) {
+                    std::rethrow_exception(e);
+                }
+            }
+        );
         io_context.run();
     } catch (std::exception &e) {
         std::cerr << e.what() << std::endl;
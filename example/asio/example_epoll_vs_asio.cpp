@@ -0,0 +1,203 @@
+// Loopback echo throughput of EpollContext against the callback style of example_asio.cpp.
+//
+// Both servers run on a single thread. The same set of blocking client threads sends
+// 64-byte requests and waits for each echo, and the completed round trips per second are
+// printed for each server. Usage: example_epoll_vs_asio [seconds] [connections]
+
+#include "myx_coroutine/epoll_context.hpp"
+#include "myx_coroutine/task.hpp"
+#include <arpa/inet.h>
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <print>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using asio::ip::tcp;
+using myx_coroutine::EpollContext;
+using myx_coroutine::Task;
+
+constexpr std::size_t kMessageSize = 64;
+
+// Opens `connections` sockets to `port` and does request/response round trips on each from
+// its own thread for `duration`. Returns the round trips completed.
+std::uint64_t run_clients(std::uint16_t port, int connections, std::chrono::seconds duration) {
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> total{0};
+    std::vector<std::jthread> clients;
+    for (int i = 0; i < connections; ++i) {
+        clients.emplace_back([&] {
+            int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(port);
+            if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+                std::println("connect failed");
+                ::close(fd);
+                return;
+            }
+            char message[kMessageSize] = {};
+            std::uint64_t count = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                if (::send(fd, message, sizeof(message), 0) != sizeof(message)) {
+                    break;
+                }
+                std::size_t received = 0;
+                while (received < sizeof(message)) {
+                    auto n = ::recv(fd, message + received, sizeof(message) - received, 0);
+                    if (n <= 0) {
+                        break;
+                    }
+                    received += n;
+                }
+                ++count;
+            }
+            total.fetch_add(count, std::memory_order_relaxed);
+            ::close(fd);
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    done.store(true, std::memory_order_relaxed);
+    clients.clear();
+    return total.load();
+}
+
+// ---- EpollContext server ----
+
+Task<> echo(EpollContext &io, int fd) {
+    int enable = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    char buffer[4096];
+    int n;
+    while ((n = co_await io.recv(fd, buffer, sizeof(buffer))) > 0) {
+        for (int sent = 0; sent < n;) {
+            int written = co_await io.send(fd, buffer + sent, n - sent, MSG_NOSIGNAL);
+            if (written <= 0) {
+                break;
+            }
+            sent += written;
+        }
+    }
+    co_await io.close(fd);
+}
+
+Task<> accept_loop(EpollContext &io, int listener) {
+    while (true) {
+        int fd = co_await io.accept(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd >= 0) {
+            io.spawn(echo(io, fd));
+        }
+    }
+}
+
+std::uint64_t bench_epoll(int connections, std::chrono::seconds duration) {
+    int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    ::bind(listener, reinterpret_cast<sockaddr *>(&addr), addrlen);
+    ::listen(listener, SOMAXCONN);
+    ::getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &addrlen);
+
+    EpollContext io;
+    io.spawn(accept_loop(io, listener));
+    std::jthread server([&] { io.run(); });
+    std::uint64_t count = run_clients(ntohs(addr.sin_port), connections, duration);
+    io.stop();
+    // The handlers are left suspended, the process is about to exit.
+    return count;
+}
+
+// ---- Asio server, in the style of example_asio.cpp ----
+
+class echo_session : public std::enable_shared_from_this<echo_session> {
+  public:
+    explicit echo_session(tcp::socket socket) : socket_(std::move(socket)) {}
+
+    void start() {
+        socket_.set_option(tcp::no_delay(true));
+        do_read();
+    }
+
+  private:
+    void do_read() {
+        auto self = shared_from_this();
+        socket_.async_read_some(asio::buffer(buffer_), [self](auto error, std::size_t n) {
+            if (!error) {
+                self->do_write(n);
+            }
+        });
+    }
+
+    void do_write(std::size_t n) {
+        auto self = shared_from_this();
+        asio::async_write(socket_, asio::buffer(buffer_, n), [self](auto error, std::size_t) {
+            if (!error) {
+                self->do_read();
+            }
+        });
+    }
+
+    tcp::socket socket_;
+    char buffer_[4096];
+};
+
+class echo_server {
+  public:
+    explicit echo_server(asio::io_context &io_context)
+        : acceptor_(io_context, tcp::endpoint(asio::ip::address_v4::loopback(), 0)) {
+        start_accept();
+    }
+
+    std::uint16_t port() const { return acceptor_.local_endpoint().port(); }
+
+  private:
+    void start_accept() {
+        acceptor_.async_accept([this](auto error, tcp::socket socket) {
+            if (!error) {
+                std::make_shared<echo_session>(std::move(socket))->start();
+            }
+            start_accept();
+        });
+    }
+
+    tcp::acceptor acceptor_;
+};
+
+std::uint64_t bench_asio(int connections, std::chrono::seconds duration) {
+    asio::io_context io_context;
+    echo_server server(io_context);
+    std::jthread thread([&] { io_context.run(); });
+    std::uint64_t count = run_clients(server.port(), connections, duration);
+    io_context.stop();
+    return count;
+}
+
+int main(int argc, char **argv) {
+    std::chrono::seconds duration(argc > 1 ? std::atoi(argv[1]) : 3);
+    int connections = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    std::uint64_t epoll_count = bench_epoll(connections, duration);
+    std::uint64_t asio_count = bench_asio(connections, duration);
+
+    auto rate = [&](std::uint64_t count) {
+        return static_cast<double>(count) / static_cast<double>(duration.count());
+    };
+    std::println("{} connections, {}s each, {} byte echo", connections, duration.count(),
+                 kMessageSize);
+    std::println("EpollContext: {:>12.0f} req/s", rate(epoll_count));
+    std::println("asio        : {:>12.0f} req/s", rate(asio_count));
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "myx_coroutine/lib.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <print>
+
+// Sums 0..n-1 through count_to (one resume per element) and through count_to_chunked (one
+// resume per chunk) and prints the time per element of both.
+
+namespace {
+template<typename F>
+void measure(const char *name, int n, F &&run) {
+    auto start = std::chrono::steady_clock::now();
+    std::int64_t sum = run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / n;
+    std::println("{:<24} sum = {}, {:.3f} ns/element", name, sum, ns);
+}
+} // namespace
+
+int main() {
+    constexpr int n = 100'000'000;
+
+    measure("per-element", n, [] {
+        std::int64_t sum = 0;
+        for (int value : myx_coroutine::count_to(n)) {
+            sum += value;
+        }
+        return sum;
+    });
+
+    std::array<int, 1024> buffer;
+    measure("chunked, flattened", n, [&buffer] {
+        std::int64_t sum = 0;
+        auto gen = myx_coroutine::count_to_chunked(n);
+        for (int value : gen.elements(buffer)) {
+            sum += value;
+        }
+        return sum;
+    });
+
+    measure("chunked, per chunk", n, [&buffer] {
+        std::int64_t sum = 0;
+        auto gen = myx_coroutine::count_to_chunked(n);
+        for (std::span<const int> chunk : gen.chunks(buffer)) {
+            // Plain loop over contiguous ints, the compiler vectorises it.
+            for (int value : chunk) {
+                sum += value;
+            }
+        }
+        return sum;
+    });
+}
@@ -0,0 +1,60 @@
+// The daytime server of example/asio/example_asio.cpp on top of IoUringContext.
+// Try it with `nc 127.0.0.1 13013`.
+
+#include "myx_coroutine/io_uring_context.hpp"
+#include "myx_coroutine/task.hpp"
+#include <arpa/inet.h>
+#include <ctime>
+#include <netinet/in.h>
+#include <print>
+#include <string>
+#include <sys/socket.h>
+
+using myx_coroutine::IoUringContext;
+using myx_coroutine::Task;
+
+std::string make_daytime_string() {
+    std::time_t now = std::time(nullptr);
+    return std::ctime(&now);
+}
+
+Task<> serve(IoUringContext &io, int fd) {
+    std::string message = make_daytime_string();
+    co_await io.send(fd, message.data(), message.size());
+    co_await io.close(fd);
+}
+
+Task<> accept_loop(IoUringContext &io, int listener) {
+    while (true) {
+        int fd = co_await io.accept(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            std::println("accept failed: {}", -fd);
+            continue;
+        }
+        io.spawn(serve(io, fd));
+    }
+}
+
+int main() {
+    int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int enable = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(13013);
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0
+        || ::listen(listener, SOMAXCONN) != 0) {
+        std::println("cannot listen on port 13013");
+        return 1;
+    }
+
+    try {
+        IoUringContext io;
+        io.spawn(accept_loop(io, listener));
+        io.run();
+    } catch (std::exception &e) {
+        std::println("{}", e.what());
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+// 1M concurrent sleeps on one TimerService, something the thread-per-sleep timer_awaiter
+// of simple_coroutine.cpp could not get near. Usage: example_timer_wheel [timers] [max_ms]
+
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/timer_service.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <vector>
+
+using myx_coroutine::Task;
+using myx_coroutine::TimerService;
+using Clock = TimerService::Clock;
+using namespace std::chrono_literals;
+
+struct Stats {
+    std::atomic<int> remaining_;
+    // Only written by the timer thread.
+    std::atomic<std::int64_t> total_late_ns_{0};
+    std::atomic<std::int64_t> max_late_ns_{0};
+};
+
+Task<> sleeper(TimerService &service, Clock::time_point deadline, Stats &stats) {
+    co_await service.sleep_until(deadline);
+    std::int64_t late = std::chrono::nanoseconds(Clock::now() - deadline).count();
+    stats.total_late_ns_.fetch_add(late, std::memory_order_relaxed);
+    if (late > stats.max_late_ns_.load(std::memory_order_relaxed)) {
+        stats.max_late_ns_.store(late, std::memory_order_relaxed);
+    }
+    if (stats.remaining_.fetch_sub(1, std::memory_order_release) == 1) {
+        stats.remaining_.notify_one();
+    }
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 1'000'000;
+    int max_ms = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    TimerService service;
+    Stats stats{count};
+    std::mt19937 rng(1);
+    std::vector<Task<>> tasks;
+    tasks.reserve(count);
+
+    auto start = Clock::now();
+    for (int i = 0; i < count; ++i) {
+        // Far enough out that every timer is in before the first one is due.
+        auto deadline = start + 1s + std::chrono::microseconds(rng() % (max_ms * 1000 + 1));
+        tasks.push_back(sleeper(service, deadline, stats));
+    }
+    auto created = Clock::now();
+    for (auto &task : tasks) {
+        task.resume();
+    }
+    auto scheduled = Clock::now();
+
+    for (int left = stats.remaining_.load(); left != 0; left = stats.remaining_.load()) {
+        stats.remaining_.wait(left);
+    }
+    auto finished = Clock::now();
+
+    using ms = std::chrono::duration<double, std::milli>;
+    std::println("{} timers spread over {} ms, starting in 1 s", count, max_ms);
+    std::println(
+        "create: {:.1f} ns/task, schedule: {:.1f} ns/timer",
+        std::chrono::nanoseconds(created - start).count() / double(count),
+        std::chrono::nanoseconds(scheduled - created).count() / double(count)
+    );
+    std::println("all fired after {:.1f} ms", ms(finished - start).count());
+    std::println(
+        "lateness: mean {:.3f} ms, max {:.3f} ms",
+        stats.total_late_ns_.load() / 1e6 / count, stats.max_late_ns_.load() / 1e6
+    );
+    return 0;
+}
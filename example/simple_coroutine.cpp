@@ -4,6 +4,7 @@
 #include <future>
 #include <iostream>
 #include <memory>
+#include <myx_coroutine/timer_service.hpp>
 #include <optional>
 #include <queue>
 #include <stdexcept>
@@ -77,17 +78,21 @@ struct suspend_never : awaiter_base<void> {
 };
 
 // 定时器等待器：等待指定时间
-struct timer_awaiter : awaiter_base<void> {
+struct timer_awaiter : awaiter_base<void>, myx_coroutine::detail::TimerNode {
     std::chrono::milliseconds duration_;
+    std::coroutine_handle<> handle_;
 
     explicit timer_awaiter(std::chrono::milliseconds duration) : duration_(duration) {}
 
-    // 重写挂起逻辑：使用线程延迟后恢复
+    // 重写挂起逻辑：由定时器线程在到期后把协程交给调度器
     void await_suspend(std::coroutine_handle<> handle) noexcept {
-        std::thread([handle, duration = duration_]() {
-            std::this_thread::sleep_for(duration);
+        handle_ = handle;
+        fire_ = [](myx_coroutine::detail::TimerNode *node) noexcept {
+            auto handle = static_cast<timer_awaiter *>(node)->handle_;
             scheduler::get_default().post([handle]() { handle.resume(); });
-        }).detach();
+        };
+        auto &timers = myx_coroutine::TimerService::get_default();
+        timers.schedule(this, myx_coroutine::TimerService::Clock::now() + duration_);
     }
 };
 
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <asio/associated_executor.hpp>
+#include <asio/async_result.hpp>
+#include <asio/detached.hpp>
+#include <asio/dispatch.hpp>
+#include <asio/error_code.hpp>
+#include <asio/executor_work_guard.hpp>
+#include <asio/post.hpp>
+#include <asio/system_error.hpp>
+#include <coroutine>
+#include <exception>
+#include <myx_coroutine/detached_task.hpp>
+#include <myx_coroutine/task.hpp>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace myx_coroutine {
+
+/// Completion token that turns an Asio initiating function into an awaitable for Task:
+///
+///     std::size_t n = co_await socket.async_read_some(asio::buffer(data), use_task);
+///
+/// The operation is started when it is awaited and the Task resumes inside the completion
+/// handler, on whatever executor Asio runs it on. A leading `error_code` is thrown as
+/// `asio::system_error`, a leading `exception_ptr` is rethrown. The remaining arguments
+/// are returned as is, as a tuple if there are several.
+struct UseTask {};
+
+inline constexpr UseTask use_task{};
+
+namespace detail {
+    template<typename Tuple>
+    auto take_asio_result(Tuple &&result) {
+        constexpr std::size_t size = std::tuple_size_v<std::remove_cvref_t<Tuple>>;
+        if constexpr (size == 0) {
+            return;
+        } else {
+            using First = std::tuple_element_t<0, std::remove_cvref_t<Tuple>>;
+            auto rest = [](auto &&, auto &&...rest) {
+                return std::make_tuple(std::move(rest)...);
+            };
+            if constexpr (std::is_same_v<First, asio::error_code>) {
+                if (std::get<0>(result)) {
+                    throw asio::system_error(std::get<0>(result));
+                }
+                return take_asio_result(std::apply(rest, std::move(result)));
+            } else if constexpr (std::is_same_v<First, std::exception_ptr>) {
+                if (std::get<0>(result)) {
+                    std::rethrow_exception(std::get<0>(result));
+                }
+                return take_asio_result(std::apply(rest, std::move(result)));
+            } else if constexpr (size == 1) {
+                return std::move(std::get<0>(result));
+            } else {
+                return std::move(result);
+            }
+        }
+    }
+
+    template<typename Signature, typename Initiation, typename... InitArgs>
+    class AsioAwaitable;
+
+    template<typename... Args, typename Initiation, typename... InitArgs>
+    class AsioAwaitable<void(Args...), Initiation, InitArgs...> {
+      public:
+        // Has no executor of its own, so Asio runs it on the I/O object's executor.
+        class Handler {
+          public:
+            explicit Handler(AsioAwaitable *awaitable) noexcept : awaitable_(awaitable) {}
+
+            void operator()(Args... args) {
+                awaitable_->result_.emplace(std::forward<Args>(args)...);
+                awaitable_->handle_.resume();
+            }
+
+          private:
+            AsioAwaitable *awaitable_;
+        };
+
+        template<typename I, typename... A>
+        explicit AsioAwaitable(I &&initiation, A &&...args)
+            : initiation_(std::forward<I>(initiation)), args_(std::forward<A>(args)...) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            std::apply(
+                [this](auto &&...args) {
+                    std::move(initiation_)(Handler{this}, std::forward<decltype(args)>(args)...);
+                },
+                std::move(args_)
+            );
+        }
+
+        auto await_resume() { return take_asio_result(std::move(*result_)); }
+
+      private:
+        Initiation initiation_;
+        std::tuple<InitArgs...> args_;
+        std::optional<std::tuple<std::decay_t<Args>...>> result_;
+        std::coroutine_handle<> handle_;
+    };
+
+    // Awaits `task` and hands its outcome to an Asio completion handler, on the handler's
+    // executor or else the one `task` was spawned on. Both count outstanding work until the
+    // handler is dispatched, like with `asio::co_spawn`: the task may be away on a pool or a
+    // timer, and `run()` must not return before its handler ran.
+    template<typename T, typename Handler, typename Executor>
+    Task<> complete_with(Task<T> task, Handler handler, Executor spawn_executor) {
+        auto executor = asio::get_associated_executor(handler, spawn_executor);
+        auto work = asio::make_work_guard(executor);
+        auto spawn_work = asio::make_work_guard(spawn_executor);
+        std::exception_ptr exception;
+        if constexpr (std::is_void_v<T>) {
+            try {
+                co_await task;
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            asio::dispatch(
+                executor,
+                [handler = std::move(handler), exception, work = std::move(work),
+                 spawn_work = std::move(spawn_work)]() mutable { std::move(handler)(exception); }
+            );
+        } else {
+            std::optional<T> value;
+            try {
+                value.emplace(co_await task);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            asio::dispatch(
+                executor,
+                [handler = std::move(handler), exception, value = std::move(value),
+                 work = std::move(work), spawn_work = std::move(spawn_work)]() mutable {
+                    std::move(handler)(exception, value ? std::move(*value) : T{});
+                }
+            );
+        }
+    }
+
+    template<typename T>
+    struct SpawnSignature {
+        using type = void(std::exception_ptr, T);
+    };
+
+    template<>
+    struct SpawnSignature<void> {
+        using type = void(std::exception_ptr);
+    };
+
+    inline void ignore_done(void *, std::exception_ptr) noexcept {}
+} // namespace detail
+
+/// Starts `task` on `executor` and reports its outcome to `token` with the signature
+/// `void(std::exception_ptr, T)`, like `asio::co_spawn`. With `asio::use_awaitable` a Task
+/// can be awaited from an `asio::awaitable`, with `asio::detached` (the default) it runs on
+/// its own and exceptions are dropped.
+template<typename Executor, typename T, typename CompletionToken = const asio::detached_t &>
+    requires(!std::is_convertible_v<Executor &, asio::execution_context &>)
+auto co_spawn(const Executor &executor, Task<T> task, CompletionToken &&token = asio::detached) {
+    using Signature = typename detail::SpawnSignature<T>::type;
+    auto initiation = [](auto handler, const Executor &executor, Task<T> task) {
+        auto spawned = detail::complete_with(std::move(task), std::move(handler), executor);
+        asio::post(executor, [task = std::move(spawned)]() mutable {
+            detail::DetachedTask::start(std::move(task), &detail::ignore_done, nullptr);
+        });
+    };
+    return asio::async_initiate<CompletionToken, Signature>(
+        initiation, token, executor, std::move(task)
+    );
+}
+
+/// Overload for execution contexts such as `asio::io_context`.
+template<
+    typename ExecutionContext, typename T, typename CompletionToken = const asio::detached_t &>
+    requires std::is_convertible_v<ExecutionContext &, asio::execution_context &>
+auto co_spawn(ExecutionContext &context, Task<T> task, CompletionToken &&token = asio::detached) {
+    return co_spawn(
+        context.get_executor(), std::move(task), std::forward<CompletionToken>(token)
+    );
+}
+} // namespace myx_coroutine
+
+template<typename... Args>
+struct asio::async_result<myx_coroutine::UseTask, void(Args...)> {
+    template<typename Initiation, typename... InitArgs>
+    static auto initiate(Initiation &&initiation, myx_coroutine::UseTask, InitArgs &&...args) {
+        return myx_coroutine::detail::AsioAwaitable<
+            void(Args...), std::decay_t<Initiation>, std::decay_t<InitArgs>...>{
+            std::forward<Initiation>(initiation), std::forward<InitArgs>(args)...
+        };
+    }
+};
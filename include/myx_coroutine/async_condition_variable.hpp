@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <myx_coroutine/async_mutex.hpp>
+#include <myx_coroutine/task.hpp>
+
+namespace myx_coroutine {
+
+/// Condition variable for coroutines waiting with an AsyncMutex held:
+///
+///     auto guard = co_await mutex.scoped_lock();
+///     co_await ready.wait(mutex, [&] { return !queue.empty(); });
+///
+/// Waiters push themselves on a lock-free stack before they release the mutex, so a notify
+/// that follows a change made under the mutex always finds them. A notified waiter is not
+/// resumed right away but moved to the mutex's queue, it runs once the mutex is handed to
+/// it, holding the lock again. Notifiers are combined like releases of an AsyncSemaphore:
+/// the first one drains, the others only count their notification.
+class AsyncConditionVariable {
+  public:
+    class WaitAwaiter : detail::AsyncWaiter {
+      public:
+        WaitAwaiter(AsyncConditionVariable &cv, AsyncMutex &mutex) noexcept
+            : cv_(cv), mutex_(mutex) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            handle_ = handle;
+            cv_.enqueue(this);
+            // May hand the mutex over to a waiter, even to this one if it was notified in
+            // the meantime, so nothing of the awaiter is touched after it.
+            mutex_.unlock();
+        }
+
+        void await_resume() const noexcept {}
+
+      private:
+        friend class AsyncConditionVariable;
+
+        AsyncConditionVariable &cv_;
+        AsyncMutex &mutex_;
+    };
+
+    AsyncConditionVariable() noexcept = default;
+
+    AsyncConditionVariable(const AsyncConditionVariable &) = delete;
+    AsyncConditionVariable &operator=(const AsyncConditionVariable &) = delete;
+
+    // Nobody may be waiting.
+    ~AsyncConditionVariable() = default;
+
+    /// Releases `mutex`, which must be held, until notified, and resumes holding it again.
+    /// Wake-ups may be spurious.
+    [[nodiscard]]
+    WaitAwaiter wait(AsyncMutex &mutex) noexcept {
+        return WaitAwaiter{*this, mutex};
+    }
+
+    template<typename Predicate>
+    Task<> wait(AsyncMutex &mutex, Predicate predicate) {
+        while (!predicate()) {
+            co_await wait(mutex);
+        }
+    }
+
+    void notify_one() noexcept { notify(1); }
+
+    void notify_all() noexcept { notify(kAll); }
+
+  private:
+    // Counted in `pending_`, wakes everybody however many notify_one are mixed in.
+    static constexpr std::size_t kAll = std::size_t{1} << 32;
+
+    void enqueue(WaitAwaiter *waiter) noexcept {
+        detail::AsyncWaiter *head = stack_.load(std::memory_order_relaxed);
+        do {
+            waiter->next_ = head;
+        } while (!stack_.compare_exchange_weak(
+            head, waiter, std::memory_order_release, std::memory_order_relaxed
+        ));
+    }
+
+    void notify(std::size_t count) noexcept;
+
+    // Takes the waiters pushed so far and appends them to `waiters_`.
+    void collect() noexcept;
+
+    // Moves `waiter` to its mutex's queue, or resumes it if the mutex is free.
+    static void requeue(detail::AsyncWaiter *waiter) noexcept;
+
+    std::atomic<detail::AsyncWaiter *> stack_{nullptr};
+    // Notifications not handled yet. The notify that raises it from zero drains it.
+    std::atomic<std::size_t> pending_{0};
+    // Waiters in arrival order, taken off the stack by the drainer. Only it touches them.
+    detail::AsyncWaiter *waiters_ = nullptr;
+    detail::AsyncWaiter *waiters_tail_ = nullptr;
+};
+} // namespace myx_coroutine
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <myx_coroutine/frame_allocator.hpp>
+#include <myx_coroutine/task.hpp>
+#include <myx_coroutine/util.h>
+#include <type_traits>
+#include <utility>
+
+namespace myx_coroutine {
+
+template<typename T>
+class AsyncGenerator;
+
+namespace detail {
+    /// Promise of a generator that may `co_await` between yields.
+    ///
+    /// It starts lazily and only runs while a consumer awaits `next()`: the consumer's handle
+    /// is stored like a Task continuation, and both `co_yield` and the final suspend point
+    /// transfer straight back to it. The producer is therefore never more than one element
+    /// ahead of the consumer. Like Generator, it only keeps a pointer to the yielded object.
+    template<typename T>
+    struct AsyncGeneratorPromise : PromiseAllocation {
+        using value_type = std::remove_cvref_t<T>;
+        // Const and taking const lvalues for a value type, as Generator.
+        using reference = std::conditional_t<std::is_reference_v<T>, T, const T &>;
+        using pointer = std::add_pointer_t<reference>;
+        using yielded_lvalue =
+            std::conditional_t<std::is_reference_v<T>, std::remove_reference_t<T> &, const T &>;
+        using handle_type = std::coroutine_handle<AsyncGeneratorPromise>;
+
+        // Hands control back to whoever awaits `next()`.
+        struct yield_awaiter {
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(handle_type handle) noexcept {
+                return handle.promise().consumer_;
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        AsyncGenerator<T> get_return_object() noexcept {
+            return AsyncGenerator<T>{handle_type::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        yield_awaiter final_suspend() const noexcept { return {}; }
+
+        void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+        void return_void() const noexcept {}
+
+        yield_awaiter yield_value(yielded_lvalue value) noexcept {
+            value_ = std::addressof(value);
+            return {};
+        }
+
+        yield_awaiter yield_value(std::remove_reference_t<T> &&value) noexcept {
+            value_ = std::addressof(value);
+            return {};
+        }
+
+        reference value() const noexcept { return static_cast<reference>(*value_); }
+
+        std::coroutine_handle<> consumer_{std::noop_coroutine()};
+        std::exception_ptr exception_;
+        pointer value_ = nullptr;
+    };
+} // namespace detail
+
+/// A generator whose body can `co_await` tasks or I/O between yields:
+///
+///     while (co_await gen.next()) {
+///         use(gen.value());
+///     }
+///
+/// `value()` refers to the object the producer yielded and stays valid until the next call
+/// to `next()`.
+template<typename T>
+class AsyncGenerator {
+  public:
+    using promise_type = detail::AsyncGeneratorPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit AsyncGenerator(handle_type handle) noexcept : handle_(handle) {}
+
+    AsyncGenerator(AsyncGenerator &&rhs) noexcept : handle_(std::exchange(rhs.handle_, nullptr)) {}
+
+    AsyncGenerator(const AsyncGenerator &) = delete;
+    AsyncGenerator &operator=(const AsyncGenerator &) = delete;
+    AsyncGenerator &operator=(AsyncGenerator &&) = delete;
+
+    ~AsyncGenerator() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    class NextAwaiter {
+      public:
+        explicit NextAwaiter(handle_type handle) noexcept : handle_(handle) {}
+
+        bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept {
+            handle_.promise().consumer_ = consumer;
+            return handle_;
+        }
+
+        /// True if a value was produced, false once the generator has finished.
+        bool await_resume() const {
+            if (!handle_) {
+                return false;
+            }
+            if (handle_.done()) {
+                if (handle_.promise().exception_) {
+                    std::rethrow_exception(handle_.promise().exception_);
+                }
+                return false;
+            }
+            return true;
+        }
+
+      private:
+        handle_type handle_;
+    };
+
+    /// Resumes the producer until it yields the next value or finishes.
+    [[nodiscard]]
+    NextAwaiter next() noexcept {
+        return NextAwaiter{handle_};
+    }
+
+    typename promise_type::reference value() const noexcept {
+        MESSAGE_ASSERT(handle_ && !handle_.done(), "value() needs a pending element");
+        return handle_.promise().value();
+    }
+
+  private:
+    handle_type handle_;
+};
+
+/// Awaits every element of `generator` in turn and passes it to `fn`. If `fn` returns an
+/// awaitable (e.g. a Task), it is awaited before the next element is requested.
+template<typename T, typename F>
+Task<> for_each(AsyncGenerator<T> generator, F fn) {
+    while (co_await generator.next()) {
+        if constexpr (std::is_void_v<std::invoke_result_t<F &, decltype(generator.value())>>) {
+            fn(generator.value());
+        } else {
+            co_await fn(generator.value());
+        }
+    }
+}
+} // namespace myx_coroutine
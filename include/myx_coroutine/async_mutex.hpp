@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+
+namespace myx_coroutine {
+
+class AsyncConditionVariable;
+
+namespace detail {
+    // A suspended coroutine queued on one of the async primitives. It lives in the awaiter,
+    // inside the waiting coroutine's frame, so queueing never allocates.
+    struct AsyncWaiter {
+        AsyncWaiter *next_ = nullptr;
+        std::coroutine_handle<> handle_;
+    };
+
+    // Reverses a stack of waiters, newest first, into arrival order.
+    inline AsyncWaiter *reverse_waiters(AsyncWaiter *stack) noexcept {
+        AsyncWaiter *list = nullptr;
+        while (stack != nullptr) {
+            AsyncWaiter *next = stack->next_;
+            stack->next_ = list;
+            list = stack;
+            stack = next;
+        }
+        return list;
+    }
+} // namespace detail
+
+class AsyncMutex;
+
+/// Owns a locked AsyncMutex and unlocks it when destroyed.
+class AsyncMutexLock {
+  public:
+    explicit AsyncMutexLock(AsyncMutex &mutex, std::adopt_lock_t) noexcept : mutex_(&mutex) {}
+
+    AsyncMutexLock(const AsyncMutexLock &) = delete;
+    AsyncMutexLock &operator=(const AsyncMutexLock &) = delete;
+
+    AsyncMutexLock(AsyncMutexLock &&other) noexcept
+        : mutex_(std::exchange(other.mutex_, nullptr)) {}
+
+    AsyncMutexLock &operator=(AsyncMutexLock &&) = delete;
+
+    ~AsyncMutexLock();
+
+    AsyncMutex *mutex() const noexcept { return mutex_; }
+
+  private:
+    AsyncMutex *mutex_;
+};
+
+/// Mutex for coroutines: a contended `co_await mutex.lock()` suspends the coroutine instead
+/// of blocking the thread it runs on.
+///
+///     auto guard = co_await mutex.scoped_lock();
+///
+/// The whole state is one word: unlocked, locked, or the head of a lock-free stack of
+/// waiters, linked through their awaiters. Uncontended lock and unlock are a single CAS
+/// each. The holder owns the waiters already taken off the stack, so `unlock` hands the
+/// mutex directly to the oldest of them, in FIFO order, and resumes it inline.
+class AsyncMutex {
+  public:
+    class LockAwaiter : protected detail::AsyncWaiter {
+      public:
+        explicit LockAwaiter(AsyncMutex &mutex) noexcept : mutex_(mutex) {}
+
+        bool await_ready() noexcept { return mutex_.try_lock(); }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            handle_ = handle;
+            return mutex_.lock_or_enqueue(this);
+        }
+
+        void await_resume() const noexcept {}
+
+      protected:
+        AsyncMutex &mutex_;
+    };
+
+    class ScopedLockAwaiter : public LockAwaiter {
+      public:
+        using LockAwaiter::LockAwaiter;
+
+        [[nodiscard]]
+        AsyncMutexLock await_resume() const noexcept {
+            return AsyncMutexLock{mutex_, std::adopt_lock};
+        }
+    };
+
+    AsyncMutex() noexcept = default;
+
+    AsyncMutex(const AsyncMutex &) = delete;
+    AsyncMutex &operator=(const AsyncMutex &) = delete;
+
+    // Must not be locked, nobody may be waiting.
+    ~AsyncMutex() = default;
+
+    bool try_lock() noexcept {
+        std::uintptr_t expected = kNotLocked;
+        return state_.compare_exchange_strong(
+            expected, kLockedNoWaiters, std::memory_order_acquire, std::memory_order_relaxed
+        );
+    }
+
+    [[nodiscard]]
+    LockAwaiter lock() noexcept {
+        return LockAwaiter{*this};
+    }
+
+    [[nodiscard]]
+    ScopedLockAwaiter scoped_lock() noexcept {
+        return ScopedLockAwaiter{*this};
+    }
+
+    /// Called by the holder. With waiters, the next one gets the mutex and is resumed on
+    /// this thread before `unlock` returns.
+    void unlock() noexcept {
+        if (waiters_ == nullptr) {
+            std::uintptr_t expected = kLockedNoWaiters;
+            if (state_.compare_exchange_strong(
+                    expected, kNotLocked, std::memory_order_release, std::memory_order_relaxed
+                )) {
+                return;
+            }
+        }
+        unlock_slow();
+    }
+
+  private:
+    friend class AsyncConditionVariable;
+
+    // Any other value is the newest waiter, the mutex is locked.
+    static constexpr std::uintptr_t kNotLocked = 1;
+    static constexpr std::uintptr_t kLockedNoWaiters = 0;
+
+    // Takes the mutex and returns false if it is free, queues `waiter` and returns true if
+    // not.
+    bool lock_or_enqueue(detail::AsyncWaiter *waiter) noexcept;
+
+    void unlock_slow() noexcept;
+
+    std::atomic<std::uintptr_t> state_{kNotLocked};
+    // Waiters in arrival order, taken off the stack by a holder. Only touched by the holder.
+    detail::AsyncWaiter *waiters_ = nullptr;
+};
+
+inline AsyncMutexLock::~AsyncMutexLock() {
+    if (mutex_ != nullptr) {
+        mutex_->unlock();
+    }
+}
+} // namespace myx_coroutine
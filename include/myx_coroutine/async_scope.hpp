@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <myx_coroutine/task.hpp>
+#include <stop_token>
+
+namespace myx_coroutine {
+
+/// Owns fire-and-forget child tasks until they are joined, without a vector of handles.
+///
+///     AsyncScope scope;
+///     while (int fd = co_await io.accept(listener); fd >= 0) {
+///         scope.spawn(handle_connection(fd));
+///     }
+///     co_await scope.join();
+///
+/// `spawn` starts the child on the calling thread, up to its first suspension; a child that
+/// belongs on a pool begins with `co_await pool.schedule()`. A finished child's frame is freed
+/// right away by whatever thread finished it. `co_await join()` resumes once every child
+/// spawned so far has finished, exactly once, on the thread of the last one, and rethrows the
+/// first exception a child let escape; the others are dropped. The scope can be used again
+/// after a join.
+///
+/// Children get the scope's stop token unless they have one of their own, `request_stop()`
+/// cancels their timer, I/O and channel waits. The scope must be joined before it is
+/// destroyed.
+class AsyncScope {
+  public:
+    class JoinAwaiter {
+      public:
+        explicit JoinAwaiter(AsyncScope &scope) noexcept : scope_(scope) {}
+
+        bool await_ready() const noexcept {
+            return scope_.count_.load(std::memory_order_acquire) == 1;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            scope_.joiner_ = handle;
+            return scope_.count_.fetch_sub(1, std::memory_order_acq_rel) > 1;
+        }
+
+        void await_resume() { scope_.finish_join(); }
+
+      private:
+        AsyncScope &scope_;
+    };
+
+    AsyncScope() = default;
+
+    AsyncScope(const AsyncScope &) = delete;
+    AsyncScope &operator=(const AsyncScope &) = delete;
+
+    // Every child must have been joined.
+    ~AsyncScope();
+
+    /// Starts `task` and hands it to the scope. May be called from any thread until `join`
+    /// is awaited, and by running children at any time: they keep the count up.
+    void spawn(Task<> task);
+
+    /// Waits for every child spawned so far.
+    [[nodiscard]]
+    JoinAwaiter join() noexcept {
+        return JoinAwaiter{*this};
+    }
+
+    /// Children still running.
+    std::size_t active() const noexcept { return count_.load(std::memory_order_relaxed) - 1; }
+
+    std::stop_token get_stop_token() const noexcept { return stop_.get_token(); }
+
+    /// Requests stop on the token every child without its own token was given.
+    void request_stop() noexcept { stop_.request_stop(); }
+
+  private:
+    static void on_child_done(void *context, std::exception_ptr exception) noexcept;
+
+    void finish_join();
+
+    // One per running child plus one held by the joiner until it suspends, so only the last
+    // arrival after the joiner's can resume it, the same gate as `when_all`.
+    std::atomic<std::size_t> count_{1};
+    std::coroutine_handle<> joiner_;
+    std::atomic<bool> failed_{false};
+    // Written by the child that set `failed_`, read by the joiner after the count hit zero.
+    std::exception_ptr exception_;
+    std::stop_source stop_;
+};
+} // namespace myx_coroutine
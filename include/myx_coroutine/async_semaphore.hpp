@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <myx_coroutine/async_mutex.hpp>
+
+namespace myx_coroutine {
+
+/// Counting semaphore for coroutines: `co_await semaphore.acquire()` suspends while no
+/// permit is left.
+///
+/// One word holds either the number of free permits or, when there are none, the head of a
+/// lock-free stack of waiters, so an uncontended acquire or release is a single CAS. A
+/// release that finds waiters gives its permit straight to the oldest one and resumes it
+/// inline. Concurrent releasers are combined: the first becomes the drainer, the others
+/// only count their permit and return, so the waiters taken off the stack are owned by one
+/// thread at a time.
+class AsyncSemaphore {
+  public:
+    class AcquireAwaiter : detail::AsyncWaiter {
+      public:
+        explicit AcquireAwaiter(AsyncSemaphore &semaphore) noexcept : semaphore_(semaphore) {}
+
+        bool await_ready() noexcept { return semaphore_.try_acquire(); }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            handle_ = handle;
+            return semaphore_.acquire_or_enqueue(this);
+        }
+
+        void await_resume() const noexcept {}
+
+      private:
+        AsyncSemaphore &semaphore_;
+    };
+
+    explicit AsyncSemaphore(std::size_t permits) noexcept : state_(encode(permits)) {}
+
+    AsyncSemaphore(const AsyncSemaphore &) = delete;
+    AsyncSemaphore &operator=(const AsyncSemaphore &) = delete;
+
+    // Nobody may be waiting.
+    ~AsyncSemaphore() = default;
+
+    bool try_acquire() noexcept {
+        std::uintptr_t state = state_.load(std::memory_order_relaxed);
+        while (is_count(state) && state != encode(0)) {
+            if (state_.compare_exchange_weak(
+                    state, state - kOne, std::memory_order_acquire, std::memory_order_relaxed
+                )) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]]
+    AcquireAwaiter acquire() noexcept {
+        return AcquireAwaiter{*this};
+    }
+
+    /// Gives back `count` permits. Without a concurrent release draining the waiters, the ones
+    /// they go to are resumed inline before this returns; otherwise the permits are handed to
+    /// the active drainer, which resumes those waiters on its own thread.
+    void release(std::size_t count = 1) noexcept {
+        std::uintptr_t state = state_.load(std::memory_order_relaxed);
+        while (is_count(state)) {
+            if (state_.compare_exchange_weak(
+                    state, state + count * kOne, std::memory_order_release,
+                    std::memory_order_relaxed
+                )) {
+                return;
+            }
+        }
+        release_slow(count);
+    }
+
+    // Free permits right now, zero while anybody waits.
+    std::size_t available() const noexcept {
+        std::uintptr_t state = state_.load(std::memory_order_relaxed);
+        return is_count(state) ? state >> 1 : 0;
+    }
+
+  private:
+    // Odd values are a permit count, `(permits << 1) | 1`, and mean nobody waits. Even
+    // values mean no permits: the newest waiter on the stack, or null with an empty stack.
+    static constexpr std::uintptr_t kOne = 2;
+
+    static constexpr std::uintptr_t encode(std::size_t permits) noexcept {
+        return (static_cast<std::uintptr_t>(permits) << 1) | 1;
+    }
+
+    static constexpr bool is_count(std::uintptr_t state) noexcept { return (state & 1) != 0; }
+
+    // Takes a permit and returns false if there is one, queues `waiter` and returns true if
+    // not.
+    bool acquire_or_enqueue(detail::AsyncWaiter *waiter) noexcept;
+
+    void release_slow(std::size_t count) noexcept;
+
+    // Hands one permit to the oldest waiter, or stores it if there is none. Drainer only.
+    void release_one() noexcept;
+
+    std::atomic<std::uintptr_t> state_;
+    // Permits released while the stack was not empty and not handed out yet. The release
+    // that raises it from zero drains it.
+    std::atomic<std::size_t> pending_{0};
+    // Waiters in arrival order, taken off the stack by the drainer. Only it touches them,
+    // and while there are any the state stays even, so no release takes the fast path.
+    detail::AsyncWaiter *waiters_ = nullptr;
+};
+} // namespace myx_coroutine
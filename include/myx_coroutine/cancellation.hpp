@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <myx_coroutine/task.hpp>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+
+namespace myx_coroutine {
+
+/// Thrown from `co_await` on a timer, I/O or channel operation that was abandoned because
+/// stop was requested on the awaiting Task's stop token.
+class OperationCancelled : public std::runtime_error {
+  public:
+    OperationCancelled() : std::runtime_error("operation cancelled") {}
+};
+
+namespace detail {
+    struct GetStopTokenAwaiter {
+        std::stop_token token_;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            token_ = stop_token_of(handle);
+            return false;
+        }
+
+        std::stop_token await_resume() noexcept { return std::move(token_); }
+    };
+
+    /// Cancellation handshake of an operation that is completed by an owner thread (an event
+    /// loop, the timer thread) while a stop callback may fire on any thread.
+    ///
+    /// The callback never touches the operation itself, it only asks the owner to cancel it
+    /// through `request_`, which queues it. The owner then either cancels it or, if its result
+    /// arrived first, resumes it with that result. One atomic state decides the race, and the
+    /// operation is resumed exactly once, by the owner. Without a stop token nothing is
+    /// registered and `complete` costs no atomic operation.
+    class CancellableOperation {
+      public:
+        using RequestFn = void (*)(void *owner, CancellableOperation *operation) noexcept;
+
+        CancellableOperation(RequestFn request, void *owner) noexcept
+            : request_(request), owner_(owner) {}
+
+        CancellableOperation(const CancellableOperation &) = delete;
+        CancellableOperation &operator=(const CancellableOperation &) = delete;
+
+        /// Before the operation is handed to its owner. Returns false, and the operation
+        /// counts as cancelled, if stop was requested already; it must not be started then.
+        bool prepare(const std::stop_token &token) noexcept {
+            if (token.stop_requested()) {
+                cancelled_ = true;
+                return false;
+            }
+            cancellable_ = token.stop_possible();
+            state_.store(cancellable_ ? kArming : kWaiting, std::memory_order_relaxed);
+            return true;
+        }
+
+        /// Whether `arm` is needed. Read it before handing the operation to its owner: without
+        /// a stop callback the owner may resume the coroutine, and free the operation, at once.
+        bool cancellable() const noexcept { return cancellable_; }
+
+        /// After a cancellable operation was handed to its owner: registers the stop callback.
+        /// Returns false if the operation completed in the meantime and must not suspend.
+        bool arm(const std::stop_token &token) noexcept {
+            // A stop already requested runs the callback right here, it leaves queueing the
+            // request to us: the owner could otherwise resume the coroutine and destroy the
+            // callback before its constructor has returned.
+            on_stop_.emplace(token, OnStop{this});
+            std::uint8_t state = kArming;
+            if (state_.compare_exchange_strong(state, kWaiting, std::memory_order_acq_rel)) {
+                return true;
+            }
+            if (state == kCompleted) {
+                return false;
+            }
+            request_(owner_, this);
+            return true;
+        }
+
+        /// Owner: the result is in. Returns true if the owner resumes the coroutine now, false
+        /// if a cancel request is queued and the coroutine is resumed when it is taken off.
+        bool complete() noexcept {
+            if (!cancellable_) {
+                return true;
+            }
+            std::uint8_t state = state_.exchange(kCompleted, std::memory_order_acq_rel);
+            return state == kWaiting || state == kCancelling;
+        }
+
+        /// Owner, for a request taken off its queue: true if the operation has to be
+        /// cancelled, false if it completed first and is to be resumed with its result.
+        bool begin_cancel() noexcept {
+            std::uint8_t state = kCancelRequested;
+            cancelled_ = state_.compare_exchange_strong(
+                state, kCancelling, std::memory_order_acq_rel
+            );
+            return cancelled_;
+        }
+
+        /// Whether the owner went for cancelling, read once the coroutine is resumed.
+        bool cancelled() const noexcept { return cancelled_; }
+
+        // Link in the owner's queue of cancel requests.
+        CancellableOperation *cancel_next_ = nullptr;
+
+      private:
+        // Handed to the owner, not completed, no stop callback registered yet.
+        static constexpr std::uint8_t kArming = 0;
+        static constexpr std::uint8_t kWaiting = 1;
+        // The stop callback fired, a cancel request is (about to be) queued.
+        static constexpr std::uint8_t kCancelRequested = 2;
+        // The owner took the request and is cancelling the operation.
+        static constexpr std::uint8_t kCancelling = 3;
+        static constexpr std::uint8_t kCompleted = 4;
+
+        struct OnStop {
+            CancellableOperation *self_;
+
+            void operator()() const noexcept { self_->on_stop(); }
+        };
+
+        void on_stop() noexcept {
+            std::uint8_t state = state_.load(std::memory_order_acquire);
+            while (state == kWaiting || state == kArming) {
+                if (state_.compare_exchange_weak(
+                        state, kCancelRequested, std::memory_order_acq_rel
+                    )) {
+                    if (state == kWaiting) {
+                        request_(owner_, this);
+                    }
+                    return;
+                }
+            }
+        }
+
+        RequestFn request_;
+        void *owner_;
+        bool cancellable_ = false;
+        bool cancelled_ = false;
+        std::atomic<std::uint8_t> state_{kWaiting};
+        std::optional<std::stop_callback<OnStop>> on_stop_;
+    };
+
+    /// Lock-free stack of cancel requests, pushed from any thread and drained by the owner.
+    class CancelQueue {
+      public:
+        // Returns true if the queue was empty, the owner may need waking up.
+        bool push(CancellableOperation *operation) noexcept {
+            CancellableOperation *head = head_.load(std::memory_order_relaxed);
+            do {
+                operation->cancel_next_ = head;
+            } while (!head_.compare_exchange_weak(
+                head, operation, std::memory_order_release, std::memory_order_relaxed
+            ));
+            return head == nullptr;
+        }
+
+        CancellableOperation *take_all() noexcept {
+            return head_.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        bool empty() const noexcept { return head_.load(std::memory_order_relaxed) == nullptr; }
+
+      private:
+        std::atomic<CancellableOperation *> head_{nullptr};
+    };
+} // namespace detail
+
+/// `co_await get_stop_token()` returns the stop token of the current Task: the one set with
+/// `Task::set_stop_token`, or inherited from the task awaiting it.
+[[nodiscard]]
+inline detail::GetStopTokenAwaiter get_stop_token() noexcept {
+    return {};
+}
+} // namespace myx_coroutine
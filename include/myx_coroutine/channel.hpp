@@ -0,0 +1,799 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <myx_coroutine/cancellation.hpp>
+#include <optional>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace myx_coroutine {
+
+enum class ChannelMode {
+    // Any number of senders and receivers.
+    Mpmc,
+    // At most one coroutine sending and one receiving at a time, bounded only.
+    Spsc,
+};
+
+namespace detail {
+    // FIFO of waiters linked through their `next_`, which live in the awaiters.
+    template<typename Node>
+    class IntrusiveQueue {
+      public:
+        bool empty() const noexcept { return head_ == nullptr; }
+
+        void push_back(Node *node) noexcept {
+            node->next_ = nullptr;
+            if (tail_ == nullptr) {
+                head_ = node;
+            } else {
+                tail_->next_ = node;
+            }
+            tail_ = node;
+        }
+
+        Node *pop_front() noexcept {
+            Node *node = head_;
+            if (node != nullptr) {
+                head_ = node->next_;
+                if (head_ == nullptr) {
+                    tail_ = nullptr;
+                }
+            }
+            return node;
+        }
+
+        // Empties the queue, returns what it held as a null-terminated list.
+        Node *take_all() noexcept {
+            Node *node = head_;
+            head_ = tail_ = nullptr;
+            return node;
+        }
+
+        // Unlinks `node`, which must be queued.
+        void remove(Node *node) noexcept {
+            Node *prev = nullptr;
+            Node *current = head_;
+            while (current != node) {
+                prev = current;
+                current = current->next_;
+            }
+            (prev == nullptr ? head_ : prev->next_) = node->next_;
+            if (tail_ == node) {
+                tail_ = prev;
+            }
+        }
+
+      private:
+        Node *head_ = nullptr;
+        Node *tail_ = nullptr;
+    };
+
+    // Where a channel waiter is, guarded by the channel's mutex.
+    enum class ChannelWait : std::uint8_t {
+        Idle,
+        Queued,
+        Done,
+        Cancelled,
+    };
+
+    // Resumes a list of waiters, reading each link before the waiter can go away.
+    template<typename Node>
+    void resume_all(Node *node) noexcept {
+        while (node != nullptr) {
+            Node *next = node->next_;
+            node->handle_.resume();
+            node = next;
+        }
+    }
+} // namespace detail
+
+/// Channel between coroutines: `co_await ch.send(v)` suspends while the channel is full,
+/// `co_await ch.recv()` while it is empty, instead of blocking the thread like
+/// `ConcurrentQueue::pop`.
+///
+///     Channel<int> ch(64);
+///     while (auto value = co_await ch.recv()) { ... }
+///
+/// `close()` makes every later send fail, suspended senders resume with `false` and their
+/// value undelivered. Receivers still drain what is buffered, then get `std::nullopt`.
+///
+/// The buffer and the waiter queues sit behind a mutex that is held for a few pointer
+/// operations and never across a suspension. A value meant for a suspended receiver is
+/// handed to it directly, and waiters are resumed inline by the coroutine that unblocked
+/// them, after the mutex is released. A capacity of 0 makes every send a rendezvous with a
+/// receiver.
+///
+/// A waiter whose Task's stop token is triggered is taken off its queue by the stop callback
+/// and resumed there, `co_await` then throws OperationCancelled and nothing was sent or
+/// received.
+template<typename T, ChannelMode Mode = ChannelMode::Mpmc>
+class Channel {
+    struct Sender {
+        Sender *next_ = nullptr;
+        std::coroutine_handle<> handle_;
+        T *value_ = nullptr;
+        bool ok_ = false;
+        detail::ChannelWait state_ = detail::ChannelWait::Idle;
+    };
+
+    struct Receiver {
+        Receiver *next_ = nullptr;
+        std::coroutine_handle<> handle_;
+        std::optional<T> value_;
+        detail::ChannelWait state_ = detail::ChannelWait::Idle;
+    };
+
+    template<typename Node>
+    struct CancelWait {
+        Channel *channel_;
+        Node *node_;
+
+        void operator()() const noexcept { channel_->cancel(node_); }
+    };
+
+    template<typename Node>
+    using OnStop = std::optional<std::stop_callback<CancelWait<Node>>>;
+
+  public:
+    static constexpr std::size_t kUnbounded = std::numeric_limits<std::size_t>::max();
+
+    class SendAwaiter {
+      public:
+        SendAwaiter(Channel &channel, T value) : channel_(channel), value_(std::move(value)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            node_.handle_ = handle;
+            node_.value_ = &value_;
+            return channel_.watch_stop(node_, on_stop_, detail::stop_token_of(handle))
+                   && channel_.send_or_enqueue(&node_);
+        }
+
+        /// False if the channel was closed and the value not delivered.
+        bool await_resume() const {
+            if (node_.state_ == detail::ChannelWait::Cancelled) {
+                throw OperationCancelled{};
+            }
+            return node_.ok_;
+        }
+
+      private:
+        Channel &channel_;
+        T value_;
+        Sender node_;
+        OnStop<Sender> on_stop_;
+    };
+
+    class RecvAwaiter {
+      public:
+        explicit RecvAwaiter(Channel &channel) noexcept : channel_(channel) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            node_.handle_ = handle;
+            return channel_.watch_stop(node_, on_stop_, detail::stop_token_of(handle))
+                   && channel_.recv_or_enqueue(&node_);
+        }
+
+        /// Empty once the channel is closed and drained.
+        std::optional<T> await_resume() {
+            if (node_.state_ == detail::ChannelWait::Cancelled) {
+                throw OperationCancelled{};
+            }
+            return std::move(node_.value_);
+        }
+
+      private:
+        Channel &channel_;
+        Receiver node_;
+        OnStop<Receiver> on_stop_;
+    };
+
+    class RecvBatchAwaiter {
+      public:
+        RecvBatchAwaiter(Channel &channel, std::size_t max) noexcept
+            : channel_(channel), max_(max) {}
+
+        bool await_ready() { return channel_.try_recv_batch(values_, max_) != 0; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            node_.handle_ = handle;
+            return channel_.watch_stop(node_, on_stop_, detail::stop_token_of(handle))
+                   && channel_.recv_or_enqueue(&node_);
+        }
+
+        /// Between 1 and `max` values, none once the channel is closed and drained.
+        std::vector<T> await_resume() {
+            if (node_.state_ == detail::ChannelWait::Cancelled) {
+                throw OperationCancelled{};
+            }
+            if (node_.value_) {
+                values_.push_back(std::move(*node_.value_));
+                channel_.try_recv_batch(values_, max_ - 1);
+            }
+            return std::move(values_);
+        }
+
+      private:
+        Channel &channel_;
+        std::size_t max_;
+        Receiver node_;
+        std::vector<T> values_;
+        OnStop<Receiver> on_stop_;
+    };
+
+    Channel() = default;
+
+    explicit Channel(std::size_t capacity) : capacity_(capacity) {}
+
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    // Nobody may be suspended on it.
+    ~Channel() = default;
+
+    [[nodiscard]]
+    SendAwaiter send(T value) {
+        return SendAwaiter{*this, std::move(value)};
+    }
+
+    [[nodiscard]]
+    RecvAwaiter recv() noexcept {
+        return RecvAwaiter{*this};
+    }
+
+    /// Waits for at least one value and takes up to `max` (at least 1) in one go.
+    [[nodiscard]]
+    RecvBatchAwaiter recv_batch(std::size_t max) noexcept {
+        return RecvBatchAwaiter{*this, max};
+    }
+
+    /// Sends without waiting. Returns false, leaving `value` alone, if the channel is full or
+    /// closed.
+    bool try_send(T &value) {
+        std::unique_lock lock(mtx_);
+        if (closed_) {
+            return false;
+        }
+        if (Receiver *receiver = receivers_.pop_front()) {
+            receiver->value_.emplace(std::move(value));
+            receiver->state_ = detail::ChannelWait::Done;
+            lock.unlock();
+            receiver->handle_.resume();
+            return true;
+        }
+        if (buffer_.size() < capacity_) {
+            buffer_.push_back(std::move(value));
+            return true;
+        }
+        return false;
+    }
+
+    std::optional<T> try_recv() {
+        std::optional<T> value;
+        Sender *woken = nullptr;
+        {
+            std::lock_guard lock(mtx_);
+            woken = take(value);
+        }
+        if (woken != nullptr) {
+            woken->handle_.resume();
+        }
+        return value;
+    }
+
+    /// Appends up to `max` values to `out` without waiting, returns how many.
+    std::size_t try_recv_batch(std::vector<T> &out, std::size_t max) {
+        std::size_t count = 0;
+        detail::IntrusiveQueue<Sender> woken;
+        {
+            std::lock_guard lock(mtx_);
+            std::optional<T> value;
+            while (count < max) {
+                Sender *sender = take(value);
+                if (!value) {
+                    break;
+                }
+                out.push_back(std::move(*value));
+                value.reset();
+                ++count;
+                if (sender != nullptr) {
+                    woken.push_back(sender);
+                }
+            }
+        }
+        detail::resume_all(woken.take_all());
+        return count;
+    }
+
+    void close() {
+        Sender *senders;
+        Receiver *receivers;
+        {
+            std::lock_guard lock(mtx_);
+            closed_ = true;
+            senders = senders_.take_all();
+            // Only waiting while the buffer is empty, they get nothing.
+            receivers = receivers_.take_all();
+            mark_done(senders);
+            mark_done(receivers);
+        }
+        detail::resume_all(senders);
+        detail::resume_all(receivers);
+    }
+
+    bool is_closed() const {
+        std::lock_guard lock(mtx_);
+        return closed_;
+    }
+
+    std::size_t size() const {
+        std::lock_guard lock(mtx_);
+        return buffer_.size();
+    }
+
+    std::size_t capacity() const noexcept { return capacity_; }
+
+  private:
+    // Returns false, the node counting as cancelled, if stop was requested already.
+    // Otherwise registers the stop callback, which may then run at any time.
+    template<typename Node>
+    bool watch_stop(Node &node, OnStop<Node> &on_stop, const std::stop_token &token) {
+        if (token.stop_requested()) {
+            node.state_ = detail::ChannelWait::Cancelled;
+            return false;
+        }
+        if (token.stop_possible()) {
+            on_stop.emplace(token, CancelWait<Node>{this, &node});
+        }
+        return true;
+    }
+
+    // Stop callback: a queued node is unlinked and resumed here, one that is not queued yet
+    // finds itself cancelled when it tries to wait, one that was served keeps its result.
+    template<typename Node>
+    void cancel(Node *node) noexcept {
+        {
+            std::lock_guard lock(mtx_);
+            detail::ChannelWait state = node->state_;
+            if (state == detail::ChannelWait::Idle) {
+                node->state_ = detail::ChannelWait::Cancelled;
+                return;
+            }
+            if (state != detail::ChannelWait::Queued) {
+                return;
+            }
+            if constexpr (std::is_same_v<Node, Sender>) {
+                senders_.remove(node);
+            } else {
+                receivers_.remove(node);
+            }
+            node->state_ = detail::ChannelWait::Cancelled;
+        }
+        node->handle_.resume();
+    }
+
+    template<typename Node>
+    static void mark_done(Node *node) noexcept {
+        for (; node != nullptr; node = node->next_) {
+            node->state_ = detail::ChannelWait::Done;
+        }
+    }
+
+    // Returns true if `sender` has to wait.
+    bool send_or_enqueue(Sender *sender) {
+        std::unique_lock lock(mtx_);
+        bool cancelled = sender->state_ == detail::ChannelWait::Cancelled;
+        sender->state_ = detail::ChannelWait::Done;
+        if (closed_) {
+            return false;
+        }
+        sender->ok_ = true;
+        if (Receiver *receiver = receivers_.pop_front()) {
+            receiver->value_.emplace(std::move(*sender->value_));
+            receiver->state_ = detail::ChannelWait::Done;
+            lock.unlock();
+            receiver->handle_.resume();
+            return false;
+        }
+        if (buffer_.size() < capacity_) {
+            buffer_.push_back(std::move(*sender->value_));
+            return false;
+        }
+        sender->ok_ = false;
+        if (cancelled) {
+            sender->state_ = detail::ChannelWait::Cancelled;
+            return false;
+        }
+        sender->state_ = detail::ChannelWait::Queued;
+        senders_.push_back(sender);
+        return true;
+    }
+
+    // Returns true if `receiver` has to wait.
+    bool recv_or_enqueue(Receiver *receiver) {
+        Sender *woken = nullptr;
+        {
+            std::lock_guard lock(mtx_);
+            woken = take(receiver->value_);
+            if (!receiver->value_ && !closed_) {
+                if (receiver->state_ == detail::ChannelWait::Cancelled) {
+                    return false;
+                }
+                receiver->state_ = detail::ChannelWait::Queued;
+                receivers_.push_back(receiver);
+                return true;
+            }
+            receiver->state_ = detail::ChannelWait::Done;
+        }
+        if (woken != nullptr) {
+            woken->handle_.resume();
+        }
+        return false;
+    }
+
+    // Moves the oldest value into `value`, if any, and refills the buffer from the oldest
+    // suspended sender. Returns that sender, to be resumed once the mutex is released.
+    Sender *take(std::optional<T> &value) {
+        Sender *sender = senders_.pop_front();
+        if (!buffer_.empty()) {
+            value.emplace(std::move(buffer_.front()));
+            buffer_.pop_front();
+            if (sender != nullptr) {
+                buffer_.push_back(std::move(*sender->value_));
+            }
+        } else if (sender != nullptr) {
+            // Capacity 0, straight from the sender.
+            value.emplace(std::move(*sender->value_));
+        }
+        if (sender != nullptr) {
+            sender->ok_ = true;
+            sender->state_ = detail::ChannelWait::Done;
+        }
+        return sender;
+    }
+
+    mutable std::mutex mtx_;
+    std::deque<T> buffer_;
+    std::size_t capacity_ = kUnbounded;
+    bool closed_ = false;
+    detail::IntrusiveQueue<Sender> senders_;
+    detail::IntrusiveQueue<Receiver> receivers_;
+};
+
+/// Single-producer single-consumer channel: a bounded wait-free ring.
+///
+/// Each side owns one index and only reads the other's, so `try_send` / `try_recv` never
+/// loop or lock. A side that has to wait parks its handle in a one-element slot, re-checks
+/// the ring and tries to take the handle back. The other side takes it after every push or
+/// pop; whoever wins the exchange decides whether the waiter is resumed, and the other side
+/// resumes it inline.
+///
+/// Only one coroutine may send and one receive at a time, `close()` may be called from
+/// either side. A parked side whose stop token is triggered is taken back from its slot by
+/// the stop callback, which races the other side's exchange, and throws OperationCancelled.
+template<typename T>
+class Channel<T, ChannelMode::Spsc> {
+    // Stop callback of a parked side: takes its handle back and resumes it as cancelled,
+    // unless a wake-up got to it first.
+    struct Unpark {
+        std::atomic<void *> *slot_;
+        std::coroutine_handle<> handle_;
+        bool *cancelled_;
+
+        void operator()() const noexcept {
+            // Pairs with the fence in `park`, see `park_cancellable`.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (reclaim(*slot_, handle_)) {
+                *cancelled_ = true;
+                handle_.resume();
+            }
+        }
+    };
+
+    using OnStop = std::optional<std::stop_callback<Unpark>>;
+
+  public:
+    class SendAwaiter {
+      public:
+        SendAwaiter(Channel &channel, T value) : channel_(channel), value_(std::move(value)) {}
+
+        bool await_ready() {
+            if (channel_.is_closed()) {
+                done_ = true;
+                return true;
+            }
+            ok_ = done_ = channel_.try_send(value_);
+            return done_;
+        }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return channel_.park_cancellable(
+                channel_.sender_, handle, detail::stop_token_of(handle), on_stop_, cancelled_,
+                [this] { return channel_.is_closed() || !channel_.full(); }
+            );
+        }
+
+        /// False if the channel was closed and the value not delivered.
+        bool await_resume() {
+            if (cancelled_) {
+                throw OperationCancelled{};
+            }
+            if (!done_) {
+                // Woken because there is room, or because it was closed.
+                ok_ = !channel_.is_closed() && channel_.try_send(value_);
+            }
+            return ok_;
+        }
+
+      private:
+        Channel &channel_;
+        T value_;
+        bool done_ = false;
+        bool ok_ = false;
+        bool cancelled_ = false;
+        OnStop on_stop_;
+    };
+
+    class RecvAwaiter {
+      public:
+        explicit RecvAwaiter(Channel &channel) noexcept : channel_(channel) {}
+
+        bool await_ready() {
+            value_ = channel_.try_recv();
+            return value_ || channel_.is_closed();
+        }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return channel_.park_cancellable(
+                channel_.receiver_, handle, detail::stop_token_of(handle), on_stop_, cancelled_,
+                [this] { return channel_.is_closed() || !channel_.empty(); }
+            );
+        }
+
+        /// Empty once the channel is closed and drained.
+        std::optional<T> await_resume() {
+            if (cancelled_) {
+                throw OperationCancelled{};
+            }
+            if (!value_) {
+                value_ = channel_.try_recv();
+            }
+            return std::move(value_);
+        }
+
+      private:
+        Channel &channel_;
+        std::optional<T> value_;
+        bool cancelled_ = false;
+        OnStop on_stop_;
+    };
+
+    class RecvBatchAwaiter {
+      public:
+        RecvBatchAwaiter(Channel &channel, std::size_t max) noexcept
+            : channel_(channel), max_(max) {}
+
+        bool await_ready() {
+            return channel_.try_recv_batch(values_, max_) != 0 || channel_.is_closed();
+        }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return channel_.park_cancellable(
+                channel_.receiver_, handle, detail::stop_token_of(handle), on_stop_, cancelled_,
+                [this] { return channel_.is_closed() || !channel_.empty(); }
+            );
+        }
+
+        /// Between 1 and `max` values, none once the channel is closed and drained.
+        std::vector<T> await_resume() {
+            if (cancelled_) {
+                throw OperationCancelled{};
+            }
+            if (values_.empty()) {
+                channel_.try_recv_batch(values_, max_);
+            }
+            return std::move(values_);
+        }
+
+      private:
+        Channel &channel_;
+        std::size_t max_;
+        std::vector<T> values_;
+        bool cancelled_ = false;
+        OnStop on_stop_;
+    };
+
+    /// `capacity` is rounded up to a power of two.
+    explicit Channel(std::size_t capacity)
+        : mask_(std::bit_ceil(capacity < 2 ? 2 : capacity) - 1)
+        , slots_(std::make_unique<std::optional<T>[]>(mask_ + 1)) {}
+
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    // Nobody may be suspended on it.
+    ~Channel() = default;
+
+    [[nodiscard]]
+    SendAwaiter send(T value) {
+        return SendAwaiter{*this, std::move(value)};
+    }
+
+    [[nodiscard]]
+    RecvAwaiter recv() noexcept {
+        return RecvAwaiter{*this};
+    }
+
+    [[nodiscard]]
+    RecvBatchAwaiter recv_batch(std::size_t max) noexcept {
+        return RecvBatchAwaiter{*this, max};
+    }
+
+    /// Producer only. Returns false, leaving `value` alone, if the ring is full. Does not
+    /// check for close.
+    bool try_send(T &value) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_].emplace(std::move(value));
+        tail_.store(tail + 1, std::memory_order_release);
+        wake(receiver_);
+        return true;
+    }
+
+    /// Consumer only.
+    std::optional<T> try_recv() {
+        std::optional<T> value;
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return value;
+            }
+        }
+        auto &slot = slots_[head & mask_];
+        value.emplace(std::move(*slot));
+        slot.reset();
+        head_.store(head + 1, std::memory_order_release);
+        wake(sender_);
+        return value;
+    }
+
+    /// Consumer only. Appends up to `max` values to `out`, returns how many.
+    std::size_t try_recv_batch(std::vector<T> &out, std::size_t max) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        std::size_t count = std::min(max, cached_tail_ - head);
+        if (count == 0) {
+            return 0;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            auto &slot = slots_[(head + i) & mask_];
+            out.push_back(std::move(*slot));
+            slot.reset();
+        }
+        head_.store(head + count, std::memory_order_release);
+        wake(sender_);
+        return count;
+    }
+
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        wake(sender_);
+        wake(receiver_);
+    }
+
+    bool is_closed() const noexcept { return closed_.load(std::memory_order_seq_cst); }
+
+    std::size_t size() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  private:
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+    }
+
+    bool full() const noexcept {
+        return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire)
+               > mask_;
+    }
+
+    // Publishes `handle` in `slot`, then re-checks: if `ready` already holds and the handle
+    // can be taken back, the caller goes on without suspending. Otherwise the other side
+    // owns it and resumes it.
+    template<typename Ready>
+    bool park(std::atomic<void *> &slot, std::coroutine_handle<> handle, Ready ready) noexcept {
+        slot.store(handle.address(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ready()) {
+            return slot.exchange(nullptr, std::memory_order_acq_rel) == nullptr;
+        }
+        return true;
+    }
+
+    // `park` with a stop callback registered first. A stop requested before the handle was
+    // published finds the slot empty; both sides fence, so the re-check here then sees it and
+    // takes the handle back itself.
+    template<typename Ready>
+    bool park_cancellable(
+        std::atomic<void *> &slot, std::coroutine_handle<> handle, const std::stop_token &token,
+        OnStop &on_stop, bool &cancelled, Ready ready
+    ) noexcept {
+        if (token.stop_requested()) {
+            cancelled = true;
+            return false;
+        }
+        if (token.stop_possible()) {
+            on_stop.emplace(token, Unpark{&slot, handle, &cancelled});
+        }
+        if (!park(slot, handle, ready)) {
+            return false;
+        }
+        if (token.stop_requested() && reclaim(slot, handle)) {
+            cancelled = true;
+            return false;
+        }
+        return true;
+    }
+
+    static bool reclaim(std::atomic<void *> &slot, std::coroutine_handle<> handle) noexcept {
+        void *expected = handle.address();
+        return slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+    }
+
+    // Pairs with `park`: the fence orders the index store before the load of the slot, so
+    // either this sees the handle or the waiter's re-check sees the new index.
+    static void wake(std::atomic<void *> &slot) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (slot.load(std::memory_order_relaxed) == nullptr) {
+            return;
+        }
+        if (void *address = slot.exchange(nullptr, std::memory_order_acq_rel)) {
+            std::coroutine_handle<>::from_address(address).resume();
+        }
+    }
+
+    const std::size_t mask_;
+    std::unique_ptr<std::optional<T>[]> slots_;
+    // Consumer side.
+    alignas(64) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+    // Producer side.
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+    alignas(64) std::atomic<void *> sender_{nullptr};
+    std::atomic<void *> receiver_{nullptr};
+    std::atomic<bool> closed_{false};
+};
+
+template<typename T>
+using SpscChannel = Channel<T, ChannelMode::Spsc>;
+} // namespace myx_coroutine
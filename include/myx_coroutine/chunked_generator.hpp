@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <myx_coroutine/frame_allocator.hpp>
+#include <myx_coroutine/util.h>
+#include <span>
+#include <utility>
+
+namespace myx_coroutine {
+
+template<typename T>
+class ChunkedGenerator;
+
+/// `co_await chunk_buffer` inside a ChunkedGenerator yields the buffer to fill first.
+struct ChunkBufferTag {};
+
+inline constexpr ChunkBufferTag chunk_buffer{};
+
+/// Generator that produces whole chunks per resume instead of single elements:
+///
+///     ChunkedGenerator<int> iota(int n) {
+///         std::span<int> buffer = co_await chunk_buffer;
+///         std::size_t filled = 0;
+///         for (int i = 0; i < n; ++i) {
+///             buffer[filled++] = i;
+///             if (filled == buffer.size()) {
+///                 buffer = co_yield filled;
+///                 filled = 0;
+///             }
+///         }
+///         co_yield filled;
+///     }
+///
+/// The consumer provides the buffer. `co_yield n` publishes its first `n` elements and
+/// resumes with the buffer to fill next. One resume is paid per chunk rather than per
+/// element, and `chunks()` hands out spans that can be processed in tight loops.
+template<typename T>
+struct ChunkedGeneratorPromise : detail::PromiseAllocation {
+    using handle_type = std::coroutine_handle<ChunkedGeneratorPromise>;
+
+    struct buffer_awaiter {
+        bool await_ready() const noexcept { return ready_; }
+
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+        std::span<T> await_resume() const noexcept { return promise_->buffer_; }
+
+        ChunkedGeneratorPromise *promise_;
+        bool ready_;
+    };
+
+    ChunkedGenerator<T> get_return_object() noexcept {
+        return ChunkedGenerator<T>{handle_type::from_promise(*this)};
+    }
+
+    // Lazy, the buffer is only known once the consumer starts iterating.
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    std::suspend_always final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+    void return_void() const noexcept {}
+
+    buffer_awaiter await_transform(ChunkBufferTag) noexcept { return {this, true}; }
+
+    buffer_awaiter yield_value(std::size_t count) noexcept {
+        MESSAGE_ASSERT(count <= buffer_.size(), "chunk larger than the buffer");
+        count_ = count;
+        return {this, false};
+    }
+
+    std::span<T> buffer_;
+    std::size_t count_ = 0;
+    std::exception_ptr exception_;
+};
+
+template<typename T>
+class ChunkedGenerator {
+  public:
+    using promise_type = ChunkedGeneratorPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit ChunkedGenerator(handle_type handle) noexcept : handle_(handle) {}
+
+    ChunkedGenerator(ChunkedGenerator &&rhs) noexcept
+        : handle_(std::exchange(rhs.handle_, nullptr)) {}
+
+    ChunkedGenerator(const ChunkedGenerator &) = delete;
+    ChunkedGenerator &operator=(const ChunkedGenerator &) = delete;
+    ChunkedGenerator &operator=(ChunkedGenerator &&) = delete;
+
+    ~ChunkedGenerator() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    struct chunk_iterator {
+        using value_type = std::span<const T>;
+        using difference_type = std::ptrdiff_t;
+
+        handle_type handle_;
+
+        bool is_end() const { return !handle_ || handle_.done(); }
+
+        std::span<const T> operator*() const {
+            MESSAGE_ASSERT(!is_end(), "operator* can only applies to un-finished iterator");
+            const promise_type &promise = handle_.promise();
+            return std::span<const T>(promise.buffer_.data(), promise.count_);
+        }
+
+        chunk_iterator &operator++() {
+            MESSAGE_ASSERT(!is_end(), "operator++ can only applies to un-finished iterator");
+            advance();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const { return is_end(); }
+
+        // Runs the producer to its next non-empty chunk or to its end.
+        void advance() {
+            do {
+                handle_.resume();
+            } while (!handle_.done() && handle_.promise().count_ == 0);
+            if (handle_.done() && handle_.promise().exception_) {
+                std::rethrow_exception(handle_.promise().exception_);
+            }
+        }
+    };
+
+    /// Flattens the chunks back into single elements. Stepping through a chunk is a pointer
+    /// increment, the coroutine is only resumed at chunk boundaries.
+    struct iterator {
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        chunk_iterator chunk_;
+        const T *current_ = nullptr;
+        const T *end_ = nullptr;
+
+        const T &operator*() const { return *current_; }
+
+        iterator &operator++() {
+            if (++current_ == end_) {
+                ++chunk_;
+                load();
+            }
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        // The producer is only looked at in `load`, at chunk boundaries.
+        bool operator==(std::default_sentinel_t) const { return current_ == nullptr; }
+
+        void load() {
+            if (chunk_.is_end()) {
+                current_ = end_ = nullptr;
+                return;
+            }
+            std::span<const T> chunk = *chunk_;
+            current_ = chunk.data();
+            end_ = chunk.data() + chunk.size();
+        }
+    };
+
+    template<typename Iterator>
+    struct range {
+        Iterator begin_;
+
+        Iterator begin() const { return begin_; }
+
+        std::default_sentinel_t end() const { return {}; }
+    };
+
+    /// Starts the producer on `buffer` and iterates over the chunks it fills. `buffer` must
+    /// stay alive, and the generator can only be iterated once.
+    range<chunk_iterator> chunks(std::span<T> buffer) {
+        MESSAGE_ASSERT(!buffer.empty(), "chunk buffer must not be empty");
+        handle_.promise().buffer_ = buffer;
+        chunk_iterator it{handle_};
+        it.advance();
+        return {it};
+    }
+
+    /// Like `chunks`, but yields single elements.
+    range<iterator> elements(std::span<T> buffer) {
+        iterator it{chunks(buffer).begin()};
+        it.load();
+        return {it};
+    }
+
+  private:
+    handle_type handle_;
+};
+} // namespace myx_coroutine
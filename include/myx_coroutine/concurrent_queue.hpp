@@ -32,6 +32,7 @@ class ConcurrentQueue {
         }
         x = std::move(queue_.front());
         queue_.pop();
+        return true;
     }
 
     std::size_t size() {
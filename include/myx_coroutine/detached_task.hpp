@@ -0,0 +1,60 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <myx_coroutine/task.hpp>
+#include <utility>
+
+namespace myx_coroutine {
+namespace detail {
+    /// Owns a Task<> that nobody awaits, e.g. a connection handler spawned by an event loop.
+    ///
+    /// The task is started right away. When it finishes, its frame and this node are freed
+    /// and `done(context, exception)` is called with whatever the task threw, if anything.
+    class DetachedTask : TaskCompletionHook {
+      public:
+        using DoneFn = void (*)(void *context, std::exception_ptr exception) noexcept;
+
+        static void start(Task<> task, DoneFn done, void *context) {
+            create(std::move(task), done, context)->run();
+        }
+
+        // The two halves of `start`, for callers that must account for the task only once
+        // allocating its node can no longer throw.
+        static DetachedTask *create(Task<> task, DoneFn done, void *context) {
+            return new DetachedTask(std::move(task), done, context);
+        }
+
+        void run() { task_.resume(); }
+
+      private:
+        DetachedTask(Task<> task, DoneFn done, void *context) noexcept
+            : TaskCompletionHook{&on_complete}
+            , task_(std::move(task))
+            , done_(done)
+            , context_(context) {
+            task_.promise().set_completion_hook(this);
+        }
+
+        static std::coroutine_handle<> on_complete(TaskCompletionHook *hook) noexcept {
+            auto *self = static_cast<DetachedTask *>(hook);
+            std::exception_ptr exception;
+            try {
+                self->task_.promise().get_result();
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            DoneFn done = self->done_;
+            void *context = self->context_;
+            // The task is parked at its final suspend point, destroying it is fine.
+            delete self;
+            done(context, std::move(exception));
+            return std::noop_coroutine();
+        }
+
+        Task<> task_;
+        DoneFn done_;
+        void *context_;
+    };
+} // namespace detail
+} // namespace myx_coroutine
@@ -0,0 +1,190 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <myx_coroutine/cancellation.hpp>
+#include <myx_coroutine/task.hpp>
+#include <stop_token>
+#include <sys/socket.h>
+#include <vector>
+
+namespace myx_coroutine {
+
+namespace detail {
+    // An operation waiting for its descriptor to become ready. `attempt_` performs the
+    // syscall and returns its result, or -EAGAIN to keep waiting.
+    struct EpollWaiter {
+        int (*attempt_)(EpollWaiter *) noexcept;
+        int fd_;
+        bool write_;
+        void *buffer_ = nullptr;
+        std::size_t length_ = 0;
+        // addrlen pointer for accept, addrlen for connect, offset for read/write.
+        std::uint64_t extra_ = 0;
+        int flags_ = 0;
+        std::coroutine_handle<> handle_{};
+        int result_ = 0;
+        // Set while parked.
+        CancellableOperation *operation_ = nullptr;
+    };
+} // namespace detail
+
+/// Single threaded reactor over epoll, with the same awaitable API as IoUringContext for
+/// kernels where io_uring is not available:
+///
+///     int n = co_await io.recv(fd, buffer, sizeof(buffer));
+///
+/// Every operation tries its syscall right away and only parks the coroutine if it would
+/// block, so a ready socket costs exactly the one syscall. Descriptors are switched to
+/// non-blocking mode and registered edge-triggered for both directions on first use, which
+/// is the only `epoll_ctl` they ever need. The readiness reported by the last edge is cached
+/// per descriptor: once a syscall returned EAGAIN, later operations park without trying
+/// again until the next edge.
+///
+/// That registration and cache are keyed by descriptor number, so a descriptor the context
+/// has seen must be closed with `close`, or handed to `forget` before it is closed any other
+/// way. Otherwise a new file that reuses the number is never registered and its operations
+/// park forever.
+///
+/// Results are the byte count, new descriptor or 0 on success and `-errno` on failure. A
+/// parked operation whose Task's stop token is triggered is taken off its descriptor by the
+/// loop and `co_await` throws OperationCancelled. At most one reader and one writer may wait
+/// on a descriptor at a time. Operations and `spawn`
+/// must be used from the loop thread (or before `run`), `stop` may be called from anywhere.
+class EpollContext {
+  public:
+    class Operation : detail::CancellableOperation {
+      public:
+        explicit Operation(EpollContext &context, const detail::EpollWaiter &waiter) noexcept
+            : CancellableOperation(&request_cancel, &context)
+            , context_(context)
+            , waiter_(waiter) {}
+
+        bool await_ready() { return context_.try_now(waiter_); }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            std::stop_token token = detail::stop_token_of(handle);
+            if (!prepare(token)) {
+                waiter_.result_ = -ECANCELED;
+                return false;
+            }
+            waiter_.handle_ = handle;
+            waiter_.operation_ = this;
+            bool must_arm = cancellable();
+            context_.park(waiter_);
+            return !must_arm || arm(token);
+        }
+
+        int await_resume() const {
+            if (cancelled()) {
+                throw OperationCancelled{};
+            }
+            return waiter_.result_;
+        }
+
+      private:
+        friend class EpollContext;
+
+        EpollContext &context_;
+        detail::EpollWaiter waiter_;
+    };
+
+    EpollContext();
+
+    EpollContext(const EpollContext &) = delete;
+    EpollContext &operator=(const EpollContext &) = delete;
+
+    ~EpollContext();
+
+    [[nodiscard]]
+    Operation accept(int fd, sockaddr *addr = nullptr, socklen_t *addrlen = nullptr,
+                     int flags = 0) noexcept;
+
+    [[nodiscard]]
+    Operation connect(int fd, const sockaddr *addr, socklen_t addrlen) noexcept;
+
+    [[nodiscard]]
+    Operation recv(int fd, void *buffer, std::size_t length, int flags = 0) noexcept;
+
+    [[nodiscard]]
+    Operation send(int fd, const void *buffer, std::size_t length, int flags = 0) noexcept;
+
+    // `offset` of -1 reads from / writes at the current file position.
+    [[nodiscard]]
+    Operation read(int fd, void *buffer, std::size_t length,
+                   std::uint64_t offset = -1) noexcept;
+
+    [[nodiscard]]
+    Operation write(int fd, const void *buffer, std::size_t length,
+                    std::uint64_t offset = -1) noexcept;
+
+    [[nodiscard]]
+    Operation close(int fd) noexcept;
+
+    /// Drops the registration and cached readiness of `fd`, for a descriptor that is about to
+    /// be closed or handed over without `close`. No operation may be pending on it.
+    void forget(int fd) noexcept;
+
+    /// Starts `task` right away and keeps it alive until it finishes. An exception escaping
+    /// it is rethrown from `run`.
+    void spawn(Task<> task);
+
+    /// Runs until `stop` is called or no operation and no spawned task is left.
+    void run();
+
+    /// One iteration: waits for readiness unless `wait` is false and resumes every operation
+    /// that could complete. Returns the number of operations completed.
+    std::size_t run_once(bool wait = true);
+
+    void stop() noexcept;
+
+    // Operations parked and not completed yet.
+    std::size_t pending() const noexcept { return in_flight_; }
+
+  private:
+    struct FdState {
+        bool registered_ = false;
+        // Cleared by EAGAIN, set by the next edge.
+        bool readable_ = true;
+        bool writable_ = true;
+        // Regular files cannot be polled, they are always ready.
+        bool pollable_ = true;
+        detail::EpollWaiter *reader_ = nullptr;
+        detail::EpollWaiter *writer_ = nullptr;
+    };
+
+    FdState &state_of(int fd);
+
+    bool try_now(detail::EpollWaiter &waiter);
+
+    void park(detail::EpollWaiter &waiter);
+
+    bool drive(int fd, bool write);
+
+    static void request_cancel(void *owner, detail::CancellableOperation *operation) noexcept;
+
+    // Takes every operation whose cancel was requested since the last call off its
+    // descriptor and resumes it.
+    std::size_t cancel_requested();
+
+    static void on_spawned_done(void *context, std::exception_ptr exception) noexcept;
+
+    int epoll_fd_;
+    int wakeup_fd_;
+    std::vector<FdState> fds_;
+    std::size_t in_flight_ = 0;
+    std::size_t spawned_ = 0;
+    std::exception_ptr spawned_exception_;
+    std::atomic<bool> stop_requested_{false};
+    detail::CancelQueue cancels_;
+};
+} // namespace myx_coroutine
+
+#endif
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <myx_coroutine/frame_pool.hpp>
+#include <new>
+#include <utility>
+
+namespace myx_coroutine {
+namespace detail {
+    /// Promise allocation functions shared by Task and Generator.
+    ///
+    /// A coroutine whose leading parameters are `std::allocator_arg_t, Alloc` (after the
+    /// object parameter for member functions) gets its frame from that allocator, e.g. a
+    /// `std::pmr::polymorphic_allocator` over a per-request `monotonic_buffer_resource`. Other
+    /// coroutines use the frame pool when `MYX_COROUTINE_FRAME_POOL` is set and the global
+    /// allocator otherwise.
+    ///
+    /// Every frame is followed by the function that releases it, and for custom allocators by
+    /// a copy of the allocator, so `operator delete` needs nothing but the pointer and size.
+    class PromiseAllocation {
+        using DeallocateFn = void (*)(void *frame, std::size_t size) noexcept;
+
+        // Allocators are rebound to this, so frames keep the alignment of plain `new`.
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) Block {
+            std::byte bytes_[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+        };
+
+        static constexpr std::size_t align_up(std::size_t size, std::size_t alignment) noexcept {
+            return (size + alignment - 1) & ~(alignment - 1);
+        }
+
+        static constexpr std::size_t deallocate_offset(std::size_t size) noexcept {
+            return align_up(size, alignof(DeallocateFn));
+        }
+
+        template<typename Alloc>
+        static constexpr std::size_t allocator_offset(std::size_t size) noexcept {
+            return align_up(deallocate_offset(size) + sizeof(DeallocateFn), alignof(Alloc));
+        }
+
+        template<typename Alloc>
+        static constexpr std::size_t block_count(std::size_t size) noexcept {
+            return (allocator_offset<Alloc>(size) + sizeof(Alloc) + sizeof(Block) - 1)
+                   / sizeof(Block);
+        }
+
+        static DeallocateFn &deallocate_of(void *frame, std::size_t size) noexcept {
+            return *reinterpret_cast<DeallocateFn *>(
+                static_cast<std::byte *>(frame) + deallocate_offset(size)
+            );
+        }
+
+        template<typename Alloc>
+        static Alloc *allocator_of(void *frame, std::size_t size) noexcept {
+            return reinterpret_cast<Alloc *>(
+                static_cast<std::byte *>(frame) + allocator_offset<Alloc>(size)
+            );
+        }
+
+        template<typename Alloc>
+        static void *allocate_with(const Alloc &alloc, std::size_t size) {
+            using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+            BlockAlloc block_alloc(alloc);
+            void *frame = std::allocator_traits<BlockAlloc>::allocate(
+                block_alloc, block_count<BlockAlloc>(size)
+            );
+            ::new (static_cast<void *>(allocator_of<BlockAlloc>(frame, size)))
+                BlockAlloc(std::move(block_alloc));
+            deallocate_of(frame, size) = &deallocate_with<BlockAlloc>;
+            return frame;
+        }
+
+        template<typename BlockAlloc>
+        static void deallocate_with(void *frame, std::size_t size) noexcept {
+            BlockAlloc *stored = allocator_of<BlockAlloc>(frame, size);
+            BlockAlloc block_alloc(std::move(*stored));
+            stored->~BlockAlloc();
+            std::allocator_traits<BlockAlloc>::deallocate(
+                block_alloc, static_cast<Block *>(frame), block_count<BlockAlloc>(size)
+            );
+        }
+
+        static void deallocate_default(void *frame, std::size_t) noexcept {
+#if MYX_COROUTINE_FRAME_POOL
+            frame_pool_deallocate(frame);
+#else
+            ::operator delete(frame);
+#endif
+        }
+
+      public:
+        static void *operator new(std::size_t size) {
+            std::size_t total = deallocate_offset(size) + sizeof(DeallocateFn);
+#if MYX_COROUTINE_FRAME_POOL
+            void *frame = frame_pool_allocate(total);
+#else
+            void *frame = ::operator new(total);
+#endif
+            deallocate_of(frame, size) = &deallocate_default;
+            return frame;
+        }
+
+        // Free functions: `Task<> f(std::allocator_arg_t, Alloc, Args...)`.
+        template<typename Alloc, typename... Args>
+        static void *operator new(
+            std::size_t size, std::allocator_arg_t, const Alloc &alloc, const Args &...
+        ) {
+            return allocate_with(alloc, size);
+        }
+
+        // Member functions: the object parameter comes first.
+        template<typename This, typename Alloc, typename... Args>
+        static void *operator new(
+            std::size_t size, const This &, std::allocator_arg_t, const Alloc &alloc,
+            const Args &...
+        ) {
+            return allocate_with(alloc, size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept {
+            deallocate_of(ptr, size)(ptr, size);
+        }
+    };
+} // namespace detail
+} // namespace myx_coroutine
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace myx_coroutine {
+
+/// Counters of the coroutine frame pool, summed over all threads.
+struct FramePoolStats {
+    // Allocations served from a thread's free list.
+    std::uint64_t hits = 0;
+    // Allocations that had to go to the global allocator.
+    std::uint64_t misses = 0;
+    // Frames released on a thread other than the one that allocated them.
+    std::uint64_t remote_frees = 0;
+};
+
+FramePoolStats frame_pool_stats() noexcept;
+
+namespace detail {
+    /// Per-thread size-class free lists for coroutine frames.
+    ///
+    /// A frame released on the thread that allocated it goes straight back to that thread's
+    /// free list. A frame released elsewhere is pushed onto its owner's lock-free remote list,
+    /// which the owner drains the next time its local list for that size runs dry.
+    void *frame_pool_allocate(std::size_t size);
+
+    void frame_pool_deallocate(void *ptr) noexcept;
+} // namespace detail
+} // namespace myx_coroutine
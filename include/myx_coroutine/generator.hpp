@@ -3,8 +3,11 @@
 #include <cassert>
 #include <coroutine>
 #include <exception>
+#include <memory>
+#include <myx_coroutine/frame_allocator.hpp>
 #include <myx_coroutine/util.h>
 #include <type_traits>
+#include <utility>
 
 namespace myx_coroutine {
 
@@ -12,28 +15,121 @@ template<typename T>
 class Generator;
 
 template<typename T>
-struct GeneratorPromise {
-    using value_type = std::remove_reference_t<T>;
+struct ElementsOf {
+    Generator<T> generator_;
+};
+
+/// `co_yield elements_of(inner())` yields every element of `inner` from the enclosing
+/// generator, without re-yielding them one by one.
+template<typename T>
+ElementsOf<T> elements_of(Generator<T> generator) {
+    return ElementsOf<T>{std::move(generator)};
+}
+
+/// Holds a pointer to the value passed to `co_yield` rather than a copy: the object (or the
+/// temporary materialised for it) stays alive in the coroutine frame until the generator is
+/// resumed, so iterating is free of copies and `value_type` needs no default constructor.
+///
+/// Generators nested with `elements_of` form a chain from the outermost (root) to the
+/// innermost active one (leaf). The root tracks the leaf, and the consumer reads values from
+/// and resumes the leaf directly, so an element costs one resume whatever the depth. A
+/// finished leaf hands control back to its parent by symmetric transfer.
+template<typename T>
+struct GeneratorPromise : detail::PromiseAllocation {
+    using value_type = std::remove_cvref_t<T>;
+    // Read-only for a value generator, the consumer must not write into the producer's state.
+    using reference = std::conditional_t<std::is_reference_v<T>, T, const T &>;
+    using pointer = std::add_pointer_t<reference>;
+    // A value generator also takes const lvalues, they are referenced in place like the rest.
+    using yielded_lvalue =
+        std::conditional_t<std::is_reference_v<T>, std::remove_reference_t<T> &, const T &>;
+    using handle_type = std::coroutine_handle<GeneratorPromise>;
+
+    struct final_awaiter {
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(handle_type handle) noexcept {
+            GeneratorPromise &promise = handle.promise();
+            if (promise.parent_ == nullptr) {
+                return std::noop_coroutine();
+            }
+            promise.root_->leaf_ = promise.parent_;
+            return handle_type::from_promise(*promise.parent_);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    class NestedAwaiter {
+      public:
+        explicit NestedAwaiter(Generator<T> generator) noexcept
+            : generator_(std::move(generator)) {}
+
+        // A nested generator starts eagerly, so it may be finished already.
+        bool await_ready() const noexcept {
+            return !generator_.handle_ || generator_.handle_.done();
+        }
+
+        void await_suspend(handle_type parent) noexcept {
+            GeneratorPromise &outer = parent.promise();
+            GeneratorPromise &inner = generator_.handle_.promise();
+            // `inner` may itself be suspended inside generators of its own, they all move
+            // under the outer root.
+            for (GeneratorPromise *promise = inner.leaf_; promise != &inner;
+                 promise = promise->parent_) {
+                promise->root_ = outer.root_;
+            }
+            inner.root_ = outer.root_;
+            inner.parent_ = &outer;
+            outer.root_->leaf_ = inner.leaf_;
+        }
+
+        void await_resume() {
+            if (generator_.handle_ && generator_.handle_.promise().exception_) {
+                std::rethrow_exception(generator_.handle_.promise().exception_);
+            }
+        }
+
+      private:
+        Generator<T> generator_;
+    };
 
     Generator<T> get_return_object() {
-        return Generator<T>{std::coroutine_handle<GeneratorPromise<T>>::from_promise(*this)};
+        return Generator<T>{handle_type::from_promise(*this)};
     }
 
     std::suspend_never initial_suspend() noexcept { return {}; }
 
-    std::suspend_always final_suspend() noexcept { return {}; }
+    final_awaiter final_suspend() noexcept { return {}; }
 
     void unhandled_exception() noexcept { exception_ = std::current_exception(); }
 
     void return_void() noexcept {}
 
-    std::suspend_always yield_value(value_type value) noexcept {
-        value_ = std::move(value);
+    std::suspend_always yield_value(yielded_lvalue value) noexcept {
+        value_ = std::addressof(value);
         return {};
     }
 
+    std::suspend_always yield_value(std::remove_reference_t<T> &&value) noexcept {
+        value_ = std::addressof(value);
+        return {};
+    }
+
+    NestedAwaiter yield_value(ElementsOf<T> elements) noexcept {
+        return NestedAwaiter{std::move(elements.generator_)};
+    }
+
+    reference value() const noexcept { return static_cast<reference>(*value_); }
+
+    // Only meaningful on the root.
+    handle_type leaf() const noexcept { return handle_type::from_promise(*leaf_); }
+
     std::exception_ptr exception_;
-    value_type value_;
+    pointer value_ = nullptr;
+    GeneratorPromise *root_ = this;
+    GeneratorPromise *leaf_ = this;
+    GeneratorPromise *parent_ = nullptr;
 };
 
 template<typename T = void>
@@ -42,7 +138,7 @@ class Generator {
     using promise_type = GeneratorPromise<T>;
     using handle_type = std::coroutine_handle<promise_type>;
 
-    Generator(Generator &&) = default;
+    Generator(Generator &&rhs) noexcept : handle_(std::exchange(rhs.handle_, nullptr)) {}
     Generator(const Generator &) = delete;
     Generator &operator=(const Generator &) = delete;
     Generator &operator=(Generator &&) = delete;
@@ -60,14 +156,17 @@ class Generator {
 
         bool is_end() const { return !handle_ || handle_.done(); }
 
-        T operator*() {
+        typename promise_type::reference operator*() const {
             MESSAGE_ASSERT(!is_end(), "operator* can only applies to un-finished iterator");
-            return handle_.promise().value_;
+            return handle_.promise().leaf_->value();
         }
 
+        typename promise_type::pointer operator->() const { return std::addressof(**this); }
+
         iterator &operator++() {
             MESSAGE_ASSERT(!is_end(), "operator++ can only applies to un-finished iterator");
-            handle_.resume();
+            handle_.promise().leaf().resume();
+            rethrow_if_failed();
             return *this;
         }
 
@@ -75,13 +174,25 @@ class Generator {
             MESSAGE_ASSERT(rhs.is_end(), "operator== can only applies to end iterator");
             return is_end();
         }
+
+        void rethrow_if_failed() const {
+            if (is_end() && handle_ && handle_.promise().exception_) {
+                std::rethrow_exception(handle_.promise().exception_);
+            }
+        }
     };
 
-    iterator begin() { return iterator{handle_}; }
+    iterator begin() {
+        iterator it{handle_};
+        it.rethrow_if_failed();
+        return it;
+    }
 
     iterator end() { return iterator{nullptr}; }
 
   private:
+    friend promise_type;
+
     handle_type handle_ = nullptr;
 };
 } // namespace myx_coroutine
@@ -0,0 +1,179 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <myx_coroutine/cancellation.hpp>
+#include <myx_coroutine/task.hpp>
+#include <stop_token>
+#include <sys/socket.h>
+
+namespace myx_coroutine {
+
+namespace detail {
+    // One submission queue entry worth of parameters, copied into the ring on suspend.
+    struct IoRequest {
+        std::uint8_t opcode_;
+        int fd_;
+        std::uint64_t addr_ = 0;
+        std::uint32_t len_ = 0;
+        // `off` for read/write, `addr2` for accept and connect.
+        std::uint64_t off_ = 0;
+        // `rw_flags`, `msg_flags` or `accept_flags` depending on the opcode.
+        std::uint32_t op_flags_ = 0;
+    };
+
+    // Referenced by the entry's `user_data`, filled in from its completion.
+    struct IoCompletion : CancellableOperation {
+        using CancellableOperation::CancellableOperation;
+
+        std::coroutine_handle<> handle_{};
+        int result_ = 0;
+    };
+} // namespace detail
+
+/// Single threaded event loop over an io_uring instance.
+///
+///     Task<> echo(IoUringContext &io, int fd) {
+///         char buffer[4096];
+///         int n;
+///         while ((n = co_await io.recv(fd, buffer, sizeof(buffer))) > 0) {
+///             co_await io.send(fd, buffer, n);
+///         }
+///         co_await io.close(fd);
+///     }
+///
+/// Every operation returns the completion's result: the byte count, new descriptor or 0 on
+/// success, `-errno` on failure. Operations only fill a submission queue entry; the loop
+/// submits everything queued during an iteration with the same `io_uring_enter` call that
+/// waits for completions, so a request costs no syscall of its own. Completions resume their
+/// coroutines inline on the loop thread.
+///
+/// When the awaiting Task's stop token is triggered, from any thread, the loop submits an
+/// IORING_OP_ASYNC_CANCEL for the operation; if that is what ends it, `co_await` throws
+/// OperationCancelled instead of returning `-ECANCELED`. A result that won the race is
+/// returned as usual.
+///
+/// Operations and `spawn` must be used from the loop thread (or before `run`), `stop` may be
+/// called from anywhere. Buffers and addresses must stay valid until the operation completes,
+/// which they do when they live in the awaiting coroutine. Spawned tasks should be finished
+/// before the context is destroyed, the ones still suspended are not freed.
+class IoUringContext {
+  public:
+    class Operation {
+      public:
+        Operation(IoUringContext &context, const detail::IoRequest &request) noexcept
+            : context_(context), request_(request), completion_(&request_cancel, &context) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) {
+            std::stop_token token = detail::stop_token_of(handle);
+            if (!completion_.prepare(token)) {
+                completion_.result_ = -ECANCELED;
+                return false;
+            }
+            completion_.handle_ = handle;
+            bool must_arm = completion_.cancellable();
+            context_.prepare(request_, &completion_);
+            return !must_arm || completion_.arm(token);
+        }
+
+        int await_resume() const {
+            if (completion_.cancelled() && completion_.result_ < 0) {
+                throw OperationCancelled{};
+            }
+            return completion_.result_;
+        }
+
+      private:
+        IoUringContext &context_;
+        detail::IoRequest request_;
+        detail::IoCompletion completion_;
+    };
+
+    explicit IoUringContext(unsigned entries = 256);
+
+    IoUringContext(const IoUringContext &) = delete;
+    IoUringContext &operator=(const IoUringContext &) = delete;
+
+    ~IoUringContext();
+
+    [[nodiscard]]
+    Operation accept(int fd, sockaddr *addr = nullptr, socklen_t *addrlen = nullptr,
+                     int flags = 0) noexcept;
+
+    [[nodiscard]]
+    Operation connect(int fd, const sockaddr *addr, socklen_t addrlen) noexcept;
+
+    [[nodiscard]]
+    Operation recv(int fd, void *buffer, std::size_t length, int flags = 0) noexcept;
+
+    [[nodiscard]]
+    Operation send(int fd, const void *buffer, std::size_t length, int flags = 0) noexcept;
+
+    // `offset` of -1 reads from / writes at the current file position.
+    [[nodiscard]]
+    Operation read(int fd, void *buffer, std::size_t length,
+                   std::uint64_t offset = -1) noexcept;
+
+    [[nodiscard]]
+    Operation write(int fd, const void *buffer, std::size_t length,
+                    std::uint64_t offset = -1) noexcept;
+
+    [[nodiscard]]
+    Operation close(int fd) noexcept;
+
+    /// Starts `task` right away and keeps it alive until it finishes. An exception escaping
+    /// it is rethrown from `run`.
+    void spawn(Task<> task);
+
+    /// Runs until `stop` is called or no operation and no spawned task is left.
+    void run();
+
+    /// One iteration: submits the queued entries, waits for at least one completion unless
+    /// `wait` is false, and resumes the coroutines of all available completions. Returns the
+    /// number of completions handled.
+    std::size_t run_once(bool wait = true);
+
+    void stop() noexcept;
+
+    // Operations submitted and not completed yet.
+    std::size_t pending() const noexcept { return in_flight_; }
+
+  private:
+    struct Ring;
+
+    void prepare(const detail::IoRequest &request, detail::IoCompletion *completion);
+
+    void arm_wakeup();
+
+    static void request_cancel(void *owner, detail::CancellableOperation *operation) noexcept;
+
+    // Submits a cancel for every operation whose request was queued since the last call.
+    // Returns how many had completed already and were resumed right away.
+    std::size_t cancel_requested();
+
+    void submit(bool wait);
+
+    static void on_spawned_done(void *context, std::exception_ptr exception) noexcept;
+
+    Ring *ring_;
+    int wakeup_fd_;
+    std::uint64_t wakeup_buffer_ = 0;
+    bool wakeup_armed_ = false;
+    std::size_t in_flight_ = 0;
+    std::size_t spawned_ = 0;
+    std::exception_ptr spawned_exception_;
+    std::atomic<bool> stop_requested_{false};
+    detail::CancelQueue cancels_;
+};
+} // namespace myx_coroutine
+
+#endif
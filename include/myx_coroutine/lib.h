@@ -1,7 +1,10 @@
+#include <myx_coroutine/chunked_generator.hpp>
 #include <myx_coroutine/generator.hpp>
 
 namespace myx_coroutine {
 
 Generator<int> count_to(int x);
 
+ChunkedGenerator<int> count_to_chunked(int x);
+
 } // namespace myx_coroutine
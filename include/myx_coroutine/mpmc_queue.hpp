@@ -0,0 +1,203 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace coroutine {
+
+namespace detail {
+    // Lets a thread sleep until some condition it failed to observe may have changed.
+    //
+    // Waiter: `prepare()`, re-check the condition, then `wait(epoch)`.
+    // Notifier: make the condition true, then `notify_one()` / `notify_all()`.
+    // The notifier only touches the epoch when someone is actually parked, so the uncontended
+    // path costs a fence and a load.
+    class Parker {
+      public:
+        std::uint32_t prepare() noexcept {
+            waiters_.fetch_add(1, std::memory_order_seq_cst);
+            std::uint32_t epoch = epoch_.load(std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return epoch;
+        }
+
+        void cancel() noexcept { waiters_.fetch_sub(1, std::memory_order_relaxed); }
+
+        void wait(std::uint32_t epoch) noexcept {
+            epoch_.wait(epoch, std::memory_order_acquire);
+            waiters_.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void notify_one() noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters_.load(std::memory_order_relaxed) > 0) {
+                epoch_.fetch_add(1, std::memory_order_release);
+                epoch_.notify_one();
+            }
+        }
+
+        void notify_all() noexcept {
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+            epoch_.notify_all();
+        }
+
+      private:
+        alignas(64) std::atomic<std::uint32_t> waiters_{0};
+        std::atomic<std::uint32_t> epoch_{0};
+    };
+} // namespace detail
+
+/// Bounded lock-free multi-producer multi-consumer queue (D. Vyukov's sequence-numbered ring).
+///
+/// Every cell carries a sequence number telling whether it is ready for the producer or the
+/// consumer of a given lap, so a push or pop is one CAS on the shared position plus one store
+/// on the cell, followed by the wake-up check of the opposite side (a seq_cst fence and a
+/// load, see `detail::Parker`). The blocking `push` / `pop` spin on the lock-free path first
+/// and only park on a futex when the queue is full / empty. Interface mirrors
+/// `ConcurrentQueue`.
+template<typename T>
+class BoundedMpmcQueue {
+    struct Cell {
+        std::atomic<std::size_t> seq_;
+        alignas(T) unsigned char storage_[sizeof(T)];
+
+        T *value() noexcept { return std::launder(reinterpret_cast<T *>(storage_)); }
+    };
+
+  public:
+    // capacity must be a power of two and at least 2.
+    explicit BoundedMpmcQueue(std::size_t capacity = 1024)
+        : mask_(capacity - 1)
+        , cells_(std::make_unique<Cell[]>(capacity)) {
+        assert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            cells_[i].seq_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpmcQueue(const BoundedMpmcQueue &) = delete;
+    BoundedMpmcQueue &operator=(const BoundedMpmcQueue &) = delete;
+
+    ~BoundedMpmcQueue() {
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        std::size_t enqueue = enqueue_pos_.load(std::memory_order_relaxed);
+        for (; pos != enqueue; ++pos) {
+            cells_[pos & mask_].value()->~T();
+        }
+    }
+
+    /// Blocks while the queue is full. Items pushed after `stop()` are still delivered as long
+    /// as there is room; once the queue is stopped and full, returns false without pushing.
+    bool push(T &&x) {
+        while (!try_push(std::move(x))) {
+            auto epoch = not_full_.prepare();
+            if (try_push(std::move(x))) {
+                not_full_.cancel();
+                break;
+            }
+            if (stop_.load(std::memory_order_acquire)) {
+                not_full_.cancel();
+                return false;
+            }
+            not_full_.wait(epoch);
+        }
+        return true;
+    }
+
+    bool try_push(T &&x) {
+        std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells_[pos & mask_];
+            std::size_t seq = cell.seq_.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed, std::memory_order_relaxed
+                    )) {
+                    ::new (cell.storage_) T(std::move(x));
+                    cell.seq_.store(pos + 1, std::memory_order_release);
+                    not_empty_.notify_one();
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Blocks until an item is available. Returns false once the queue is stopped and drained.
+    bool pop(T &x) {
+        while (!try_pop(x)) {
+            auto epoch = not_empty_.prepare();
+            if (try_pop(x)) {
+                not_empty_.cancel();
+                break;
+            }
+            if (stop_.load(std::memory_order_acquire)) {
+                not_empty_.cancel();
+                return false;
+            }
+            not_empty_.wait(epoch);
+        }
+        return true;
+    }
+
+    bool try_pop(T &x) {
+        std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells_[pos & mask_];
+            std::size_t seq = cell.seq_.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed, std::memory_order_relaxed
+                    )) {
+                    T *value = cell.value();
+                    x = std::move(*value);
+                    value->~T();
+                    cell.seq_.store(pos + mask_ + 1, std::memory_order_release);
+                    not_full_.notify_one();
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Approximate under concurrent modification.
+    std::size_t size() const noexcept {
+        std::size_t enqueue = enqueue_pos_.load(std::memory_order_relaxed);
+        std::size_t dequeue = dequeue_pos_.load(std::memory_order_relaxed);
+        return enqueue > dequeue ? enqueue - dequeue : 0;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    void stop() {
+        stop_.store(true, std::memory_order_release);
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+  private:
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<std::size_t> dequeue_pos_{0};
+    alignas(64) const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    std::atomic<bool> stop_ = false;
+    detail::Parker not_empty_;
+    detail::Parker not_full_;
+};
+} // namespace coroutine
@@ -1,13 +1,19 @@
+#pragma once
+
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <coroutine>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <future>
 #include <gmock/gmock.h>
 #include <memory>
 #include <mutex>
+#include <myx_coroutine/util.h>
 #include <optional>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
@@ -16,17 +22,23 @@
 
 namespace myx_coroutine {
 
-// Unit plays the role of a simplest type in case we couldn't
-// use void directly.
-//
-// User shouldn't use this directly.
-struct Unit {
-    constexpr bool operator==(const Unit &) const { return true; }
-
-    constexpr bool operator!=(const Unit &) const { return false; }
-};
+namespace detail {
+    // Intrusive callback run by the thread that completes a FutureState. It is embedded in the
+    // object waiting for the result (an awaiter in a coroutine frame, a `then` node), so
+    // registering it never allocates.
+    struct FutureContinuation {
+        void (*run_)(FutureContinuation *) = nullptr;
+    };
+} // namespace detail
 
 /// State shared by Promise and Future.
+///
+/// Readiness lives in one atomic word. The producer fills `value_` and publishes it with a
+/// release RMW, readers acquire the word before touching `value_`, so a set/get pair never
+/// takes a lock. Blocked waiters announce themselves with a waiter bit and park on the word
+/// through `std::atomic::wait`, the producer only issues a wake-up when that bit is set.
+/// `std::atomic` has no timed wait, so timed waiters fall back to the mutex and condvar.
+/// Asynchronous consumers instead register a single continuation, run by the producer.
 template<typename T>
     requires(!std::is_void_v<T>)
 class FutureState {
@@ -34,7 +46,20 @@ class FutureState {
     using ValueT = std::variant<std::monostate, T, std::exception_ptr>;
 
   private:
+    static constexpr std::uint32_t kEmpty = 0;
+    static constexpr std::uint32_t kValue = 1;
+    static constexpr std::uint32_t kException = 2;
+    static constexpr std::uint32_t kReadyMask = kValue | kException;
+    // A thread is parked in `std::atomic::wait` on `state_`.
+    static constexpr std::uint32_t kWaiter = 4;
+    // A thread is blocked in `wait_for`/`wait_until` on `cv_`.
+    static constexpr std::uint32_t kTimedWaiter = 8;
+    // `continuation_` is set and must be run on completion.
+    static constexpr std::uint32_t kContinuation = 16;
+
     ValueT value_;
+    detail::FutureContinuation *continuation_ = nullptr;
+    mutable std::atomic<std::uint32_t> state_{kEmpty};
     std::atomic<int8_t> ref_cnt_;
     mutable std::mutex mtx_;
     mutable std::condition_variable cv_;
@@ -53,63 +78,100 @@ class FutureState {
     }
 
     void detach_promise() {
-        int cnt = ref_cnt_.fetch_sub(1, std::memory_order_acq_rel) - 1;
-        // The call to has_value here in not inside a lock region, which is totally fine.
-        // Because all potential concurent operations from the thread of `Future` are read only.
-        if (!has_value() && cnt > 0) {
-            // If value has not been set yet, and there is also a future, then throw error.
+        // Only the promise side ever publishes, so nobody can make the state ready
+        // concurrently with this check. It has to happen before our reference is dropped, the
+        // future may free the state as soon as that happens.
+        if (!is_ready()) {
+            // If value has not been set yet, then throw error.
             try {
                 throw std::runtime_error("Promise is broken");
             } catch (...) {
                 set_exception(std::current_exception());
             }
         }
+        decrement_ref();
     }
 
     void wait() const {
-        std::unique_lock lock(mtx_);
-        cv_.wait(lock, [this]() { return is_ready(); });
+        std::uint32_t state = state_.load(std::memory_order_acquire);
+        while ((state & kReadyMask) == 0) {
+            if ((state & kWaiter) == 0) {
+                if (!state_.compare_exchange_weak(
+                        state, state | kWaiter, std::memory_order_acquire
+                    )) {
+                    continue;
+                }
+                state |= kWaiter;
+            }
+            state_.wait(state, std::memory_order_acquire);
+            state = state_.load(std::memory_order_acquire);
+        }
     }
 
     template<typename Rep, typename Period>
     void wait_for(const std::chrono::duration<Rep, Period> &duration) const {
-        std::unique_lock lock(mtx_);
-        cv_.wait_for(lock, duration, [this]() { return is_ready(); });
+        wait_until(std::chrono::steady_clock::now() + duration);
     }
 
     template<class Clock, class Duration>
     void wait_until(const std::chrono::time_point<Clock, Duration> &timeout) const {
+        if (is_ready()) {
+            return;
+        }
         std::unique_lock lock(mtx_);
+        // Setting the bit under the lock means a producer that sees it can only notify once
+        // we are inside `wait_until`.
+        if (state_.fetch_or(kTimedWaiter, std::memory_order_acquire) & kReadyMask) {
+            return;
+        }
         cv_.wait_until(lock, timeout, [this]() { return is_ready(); });
     }
 
+    /// Registers the callback to run once the state is ready. Returns false, without
+    /// registering, if it already is; the caller then continues inline.
+    bool set_continuation(detail::FutureContinuation *continuation) noexcept {
+        assert(continuation_ == nullptr);
+        continuation_ = continuation;
+        std::uint32_t state = state_.load(std::memory_order_acquire);
+        while ((state & kReadyMask) == 0) {
+            if (state_.compare_exchange_weak(
+                    state, state | kContinuation, std::memory_order_acq_rel,
+                    std::memory_order_acquire
+                )) {
+                return true;
+            }
+        }
+        continuation_ = nullptr;
+        return false;
+    }
+
+    bool is_ready() const noexcept {
+        return (state_.load(std::memory_order_acquire) & kReadyMask) != 0;
+    }
+
     void get(ValueT &result) const {
-        std::unique_lock lock(mtx_);
         assert(is_ready());
         result = value_;
     }
 
     void set_value(T &&value) {
-        std::unique_lock lock(mtx_);
         assert(!is_ready());
         value_.template emplace<T>(std::forward<T>(value));
-        cv_.notify_one();
+        publish(kValue);
     }
 
     void set_value()
         requires(std::is_same_v<T, Unit>)
     {
-        std::unique_lock lock(mtx_);
         assert(!is_ready());
         value_.template emplace<T>(Unit());
-        cv_.notify_one();
+        publish(kValue);
     }
 
     void set_exception(std::exception_ptr exception) {
-        std::unique_lock lock(mtx_);
         assert(!is_ready());
         value_.template emplace<std::exception_ptr>(exception);
-        cv_.notify_one();
+        publish(kException);
     }
 
     static FutureState *Init() { return new FutureState(); }
@@ -118,15 +180,65 @@ class FutureState {
     // Set to private to Prevent constructing FutureState from stack.
     FutureState() : ref_cnt_(1) {}
 
-    bool has_value() const noexcept { return std::holds_alternative<T>(value_); }
-
-    bool has_exception() const noexcept {
-        return std::holds_alternative<std::exception_ptr>(value_);
+    void publish(std::uint32_t kind) {
+        std::uint32_t prev = state_.fetch_or(kind, std::memory_order_acq_rel);
+        if (prev & kWaiter) {
+            state_.notify_all();
+        }
+        if (prev & kTimedWaiter) {
+            // Pairs with the locked registration in `wait_until`.
+            std::lock_guard lock(mtx_);
+            cv_.notify_all();
+        }
+        // Last, the continuation may release the consumer's reference. The promise still holds
+        // one, so the state outlives this call.
+        if (prev & kContinuation) {
+            continuation_->run_(continuation_);
+        }
     }
+};
 
-    bool is_ready() const noexcept { return !std::holds_alternative<std::monostate>(value_); }
+/// Executor that runs submitted work right away on the calling thread.
+struct InlineExecutor {
+    template<typename F>
+    void push_task(F &&fn) {
+        std::invoke(std::forward<F>(fn));
+    }
 };
 
+namespace detail {
+    template<typename Executor>
+    concept HasScheduleAwaiter = requires(Executor &executor, std::coroutine_handle<> handle) {
+        { executor.schedule().await_suspend(handle) } -> std::same_as<void>;
+    };
+
+    // Moves a suspended coroutine onto an executor. Executors with an allocation-free
+    // `schedule()` awaiter (ThreadPool) are driven through it, the rest get a `push_task`.
+    template<typename Executor>
+    class ExecutorHop {
+      public:
+        explicit ExecutorHop(Executor &executor) noexcept : executor_(&executor) {}
+
+        void hop(std::coroutine_handle<> handle) {
+            executor_->push_task([handle]() { handle.resume(); });
+        }
+
+      private:
+        Executor *executor_;
+    };
+
+    template<HasScheduleAwaiter Executor>
+    class ExecutorHop<Executor> {
+      public:
+        explicit ExecutorHop(Executor &executor) : awaiter_(executor.schedule()) {}
+
+        void hop(std::coroutine_handle<> handle) { awaiter_.await_suspend(handle); }
+
+      private:
+        decltype(std::declval<Executor &>().schedule()) awaiter_;
+    };
+} // namespace detail
+
 template<typename T>
 class Promise;
 
@@ -141,15 +253,36 @@ class Future {
         }
     }
 
+    template<typename F>
+    using then_result_t = typename std::conditional_t<
+        std::is_void_v<T>, std::invoke_result<F>, std::invoke_result<F, T>>::type;
+
   public:
     friend Promise<T>;
 
+    Future(Future &&rhs) noexcept : state_(std::exchange(rhs.state_, nullptr)) {}
+
+    Future &operator=(Future &&rhs) noexcept {
+        if (this != &rhs) {
+            if (state_) {
+                state_->decrement_ref();
+            }
+            state_ = std::exchange(rhs.state_, nullptr);
+        }
+        return *this;
+    }
+
+    Future(const Future &) = delete;
+    Future &operator=(const Future &) = delete;
+
     ~Future() {
         if (state_) {
             state_->decrement_ref();
         }
     }
 
+    bool is_ready() const noexcept { return state_->is_ready(); }
+
     void wait() const { state_->wait(); }
 
     template<typename Rep, typename Period>
@@ -164,6 +297,136 @@ class Future {
 
     T get() const {
         wait();
+        return get_ready();
+    }
+
+    /// `co_await future` suspends the coroutine until the promise is fulfilled. It is resumed
+    /// inline by the thread that calls `set_value`/`set_exception`.
+    class Awaiter : private detail::FutureContinuation {
+      public:
+        explicit Awaiter(const Future *future) noexcept
+            : FutureContinuation{&resume}, future_(future) {}
+
+        bool await_ready() const noexcept { return future_->is_ready(); }
+
+        bool await_suspend(std::coroutine_handle<> handle) noexcept {
+            handle_ = handle;
+            return future_->state_->set_continuation(this);
+        }
+
+        T await_resume() const { return future_->get_ready(); }
+
+      private:
+        static void resume(FutureContinuation *continuation) {
+            static_cast<Awaiter *>(continuation)->handle_.resume();
+        }
+
+        const Future *future_;
+        std::coroutine_handle<> handle_;
+    };
+
+    /// Like `co_await future`, but the coroutine always continues on `executor`.
+    template<typename Executor>
+    class ResumeOnAwaiter : private detail::FutureContinuation {
+      public:
+        ResumeOnAwaiter(const Future *future, Executor &executor)
+            : FutureContinuation{&resume}, future_(future), hop_(executor) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            if (!future_->state_->set_continuation(this)) {
+                hop_.hop(handle_);
+            }
+        }
+
+        T await_resume() const { return future_->get_ready(); }
+
+      private:
+        static void resume(FutureContinuation *continuation) {
+            auto *self = static_cast<ResumeOnAwaiter *>(continuation);
+            self->hop_.hop(self->handle_);
+        }
+
+        const Future *future_;
+        detail::ExecutorHop<Executor> hop_;
+        std::coroutine_handle<> handle_;
+    };
+
+    Awaiter operator co_await() const & noexcept { return Awaiter{this}; }
+
+    template<typename Executor>
+    [[nodiscard]]
+    ResumeOnAwaiter<Executor> resume_on(Executor &executor) const & {
+        return ResumeOnAwaiter<Executor>{this, executor};
+    }
+
+    /// Runs `fn` with the result on `executor` once it is ready and returns a future of what
+    /// `fn` returns. An exception is passed through without calling `fn`.
+    ///
+    /// `executor` is anything with `push_task(F&&)`, e.g. ThreadPool, and must outlive the
+    /// continuation. Costs one continuation node, the shared state of the returned future, and
+    /// whatever `executor.push_task` costs (a work-stealing ThreadPool boxes the closure).
+    template<typename Executor, typename F>
+    Future<then_result_t<std::decay_t<F> &>> then(Executor &executor, F &&fn) && {
+        using R = then_result_t<std::decay_t<F> &>;
+        auto *node = new ThenNode<Executor, std::decay_t<F>, R>(
+            std::move(*this), executor, std::forward<F>(fn)
+        );
+        auto future = node->promise_.get_future();
+        if (!node->source_.state_->set_continuation(node)) {
+            node->run_(node);
+        }
+        return future;
+    }
+
+    /// `then` with the continuation run by whichever thread completes the promise.
+    template<typename F>
+    Future<then_result_t<std::decay_t<F> &>> then(F &&fn) && {
+        // Stateless and constant-initialized, no guard is checked per call.
+        static constinit InlineExecutor executor;
+        return std::move(*this).then(executor, std::forward<F>(fn));
+    }
+
+  private:
+    template<typename Executor, typename F, typename R>
+    struct ThenNode : detail::FutureContinuation {
+        ThenNode(Future source, Executor &executor, F fn)
+            : FutureContinuation{&run}, source_(std::move(source)), executor_(&executor),
+              fn_(std::move(fn)) {}
+
+        static void run(FutureContinuation *continuation) {
+            auto *self = static_cast<ThenNode *>(continuation);
+            self->executor_->push_task([self]() {
+                std::unique_ptr<ThenNode> node(self);
+                try {
+                    if constexpr (std::is_void_v<T> && std::is_void_v<R>) {
+                        node->source_.get_ready();
+                        node->fn_();
+                        node->promise_.set_value();
+                    } else if constexpr (std::is_void_v<T>) {
+                        node->source_.get_ready();
+                        node->promise_.set_value(node->fn_());
+                    } else if constexpr (std::is_void_v<R>) {
+                        node->fn_(node->source_.get_ready());
+                        node->promise_.set_value();
+                    } else {
+                        node->promise_.set_value(node->fn_(node->source_.get_ready()));
+                    }
+                } catch (...) {
+                    node->promise_.set_exception(std::current_exception());
+                }
+            });
+        }
+
+        Future source_;
+        Executor *executor_;
+        F fn_;
+        Promise<R> promise_;
+    };
+
+    T get_ready() const {
         typename FutureState<value_type>::ValueT result;
         state_->get(result);
         if (std::holds_alternative<std::exception_ptr>(result)) [[unlikely]] {
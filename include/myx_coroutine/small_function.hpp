@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace coroutine {
+
+template<typename Signature, std::size_t InlineSize = 48>
+class SmallFunction;
+
+/// Move-only type-erased callable with `InlineSize` bytes of inline storage.
+///
+/// Callables that fit the buffer and are nothrow-movable are stored in place and never touch
+/// the heap, larger ones fall back to a single heap allocation. Unlike `std::function` the
+/// callable only has to be movable, so lambdas capturing `std::unique_ptr` and the like work.
+template<typename R, typename... Args, std::size_t InlineSize>
+class SmallFunction<R(Args...), InlineSize> {
+    struct VTable {
+        R (*invoke_)(void *storage, Args &&...args);
+        // Move-constructs the callable from `src` into `dst` and destroys the one in `src`.
+        void (*relocate_)(void *dst, void *src) noexcept;
+        void (*destroy_)(void *storage) noexcept;
+    };
+
+    template<typename F>
+    static constexpr bool fits_inline = sizeof(F) <= InlineSize
+                                        && alignof(F) <= alignof(std::max_align_t)
+                                        && std::is_nothrow_move_constructible_v<F>;
+
+    template<typename F>
+    static constexpr VTable inline_vtable{
+        [](void *storage, Args &&...args) -> R {
+            return std::invoke(*static_cast<F *>(storage), std::forward<Args>(args)...);
+        },
+        [](void *dst, void *src) noexcept {
+            ::new (dst) F(std::move(*static_cast<F *>(src)));
+            static_cast<F *>(src)->~F();
+        },
+        [](void *storage) noexcept { static_cast<F *>(storage)->~F(); },
+    };
+
+    template<typename F>
+    static constexpr VTable heap_vtable{
+        [](void *storage, Args &&...args) -> R {
+            return std::invoke(**static_cast<F **>(storage), std::forward<Args>(args)...);
+        },
+        [](void *dst, void *src) noexcept { ::new (dst) F *(*static_cast<F **>(src)); },
+        [](void *storage) noexcept { delete *static_cast<F **>(storage); },
+    };
+
+  public:
+    SmallFunction() noexcept = default;
+
+    SmallFunction(std::nullptr_t) noexcept {}
+
+    template<typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, SmallFunction>
+                 && std::is_invocable_r_v<R, std::decay_t<F> &, Args...>)
+    SmallFunction(F &&fn) {
+        using Fn = std::decay_t<F>;
+        if constexpr (std::is_pointer_v<Fn> || std::is_member_pointer_v<Fn>) {
+            if (fn == nullptr) {
+                return;
+            }
+        } else if constexpr (requires { fn.operator bool(); }) {
+            // Empty std::function and friends.
+            if (!fn) {
+                return;
+            }
+        }
+        if constexpr (fits_inline<Fn>) {
+            ::new (static_cast<void *>(storage_)) Fn(std::forward<F>(fn));
+            vtable_ = &inline_vtable<Fn>;
+        } else {
+            ::new (static_cast<void *>(storage_)) Fn *(new Fn(std::forward<F>(fn)));
+            vtable_ = &heap_vtable<Fn>;
+        }
+    }
+
+    SmallFunction(SmallFunction &&rhs) noexcept : vtable_(rhs.vtable_) {
+        if (vtable_ != nullptr) {
+            vtable_->relocate_(storage_, rhs.storage_);
+            rhs.vtable_ = nullptr;
+        }
+    }
+
+    SmallFunction &operator=(SmallFunction &&rhs) noexcept {
+        if (this != &rhs) {
+            reset();
+            if (rhs.vtable_ != nullptr) {
+                rhs.vtable_->relocate_(storage_, rhs.storage_);
+                vtable_ = std::exchange(rhs.vtable_, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    SmallFunction &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    SmallFunction(const SmallFunction &) = delete;
+    SmallFunction &operator=(const SmallFunction &) = delete;
+
+    ~SmallFunction() { reset(); }
+
+    R operator()(Args... args) {
+        return vtable_->invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+    /// Whether a callable of type `F` would be stored without a heap allocation.
+    template<typename F>
+    static constexpr bool is_stored_inline() noexcept {
+        return fits_inline<std::decay_t<F>>;
+    }
+
+  private:
+    void reset() noexcept {
+        if (vtable_ != nullptr) {
+            vtable_->destroy_(storage_);
+            vtable_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) std::byte storage_[InlineSize];
+    const VTable *vtable_ = nullptr;
+};
+} // namespace coroutine
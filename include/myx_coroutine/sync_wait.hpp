@@ -0,0 +1,36 @@
+#pragma once
+
+#include <coroutine>
+#include <myx_coroutine/sync_wait_event.hpp>
+#include <myx_coroutine/task.hpp>
+#include <utility>
+
+namespace myx_coroutine {
+
+namespace detail {
+    struct SyncWaitHook : TaskCompletionHook {
+        SyncWaitHook() noexcept : TaskCompletionHook{&on_complete} {}
+
+        static std::coroutine_handle<> on_complete(TaskCompletionHook *hook) noexcept {
+            static_cast<SyncWaitHook *>(hook)->event_.notify();
+            return std::noop_coroutine();
+        }
+
+        SyncWaitEvent event_;
+    };
+} // namespace detail
+
+/// Starts `task` on the calling thread and blocks until it has finished, wherever it ends up
+/// running, then returns its result or rethrows its exception.
+///
+/// Completion is signalled straight from the task's final suspend point, no extra coroutine
+/// frame is created for the wait.
+template<typename T>
+T sync_wait(Task<T> task) {
+    detail::SyncWaitHook hook;
+    task.promise().set_completion_hook(&hook);
+    task.resume();
+    hook.event_.wait();
+    return std::move(task).promise().get_result();
+}
+} // namespace myx_coroutine
@@ -1,28 +1,92 @@
-#include <condition_variable>
-#include <mutex>
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <thread>
+#endif
 
 namespace myx_coroutine {
 
+/// One-shot event for blocking a thread until some coroutine is done.
+///
+/// Lock-free: `notify` is a single atomic exchange and only enters the kernel when a thread
+/// is actually parked in `wait`.
+///
+/// The waiter may return as soon as it sees `kReady` and destroy the event, typically a stack
+/// object, while the notifier is still about to wake it. On Linux the wake is a futex call on
+/// the bare address, which never touches the memory and at worst wakes a stranger spuriously.
+/// Elsewhere the notifier publishes `kDone` as its last access and the waiter only returns
+/// once it sees that.
 struct SyncWaitEvent {
-    std::condition_variable cv_;
-    std::mutex mtx_;
-    bool is_ready_{false};
+    static constexpr std::uint32_t kNotReady = 0;
+    static constexpr std::uint32_t kReady = 1;
+    static constexpr std::uint32_t kWaiting = 2;
+    static constexpr std::uint32_t kDone = 3;
+
+    std::atomic<std::uint32_t> state_{kNotReady};
 
     void wait() {
-        std::unique_lock lock(mtx_);
-        cv_.wait(lock, [this]() { return is_ready_; });
+        std::uint32_t state = state_.load(std::memory_order_acquire);
+        if (state == kNotReady
+            && state_.compare_exchange_strong(
+                state, kWaiting, std::memory_order_acquire, std::memory_order_acquire
+            )) {
+            state = kWaiting;
+        }
+#if defined(__linux__)
+        while (state != kReady) {
+            futex(address(), FUTEX_WAIT_PRIVATE, state);
+            state = state_.load(std::memory_order_acquire);
+        }
+#else
+        while (state == kWaiting) {
+            state_.wait(state, std::memory_order_acquire);
+            state = state_.load(std::memory_order_acquire);
+        }
+        // The notifier is between its exchange and its last access, which is brief.
+        while (state != kDone) {
+            std::this_thread::yield();
+            state = state_.load(std::memory_order_acquire);
+        }
+#endif
     }
 
     void notify() {
-        std::unique_lock lock(mtx_);
-        is_ready_ = true;
-        cv_.notify_one();
+#if defined(__linux__)
+        std::uint32_t *word = address();
+#endif
+        std::uint32_t previous = state_.exchange(kReady, std::memory_order_acq_rel);
+#if defined(__linux__)
+        if (previous == kWaiting) {
+            futex(word, FUTEX_WAKE_PRIVATE, 1);
+        }
+#else
+        if (previous == kWaiting) {
+            state_.notify_one();
+        }
+        state_.store(kDone, std::memory_order_release);
+#endif
     }
 
-    void reset() {
-        std::unique_lock lock(mtx_);
-        is_ready_ = false;
+    void reset() { state_.store(kNotReady, std::memory_order_relaxed); }
+
+  private:
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+    std::uint32_t *address() noexcept { return reinterpret_cast<std::uint32_t *>(&state_); }
+
+    // Only the address is passed to the kernel, the event may already be gone for a wake.
+    static void futex(std::uint32_t *word, int op, std::uint32_t value) noexcept {
+        ::syscall(SYS_futex, word, op, value, nullptr, nullptr, 0);
     }
+#endif
 };
 
 } // namespace myx_coroutine
@@ -5,7 +5,10 @@
 #include <coroutine>
 #include <cstddef>
 #include <exception>
+#include <myx_coroutine/frame_allocator.hpp>
+#include <myx_coroutine/trace.hpp>
 #include <stdexcept>
+#include <stop_token>
 #include <utility>
 #include <variant>
 
@@ -17,32 +20,76 @@ namespace detail {
     template<typename T>
     struct TaskPromise;
 
+    // Replaces the continuation of a Task that is driven by a combinator instead of being
+    // awaited. Called from the final suspend point, the returned coroutine runs next.
+    struct TaskCompletionHook {
+        std::coroutine_handle<> (*on_complete_)(TaskCompletionHook *) noexcept = nullptr;
+    };
+
     template<typename T = void>
     struct final_awaiter {
         constexpr bool await_ready() noexcept { return false; }
 
         constexpr void await_resume() const noexcept {}
 
-        std::coroutine_handle<> await_suspend(std::coroutine_handle<TaskPromise<T>> handle) {
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<TaskPromise<T>> handle
+        ) noexcept {
             return handle.promise().get_continuation();
         }
     };
 
     template<typename T>
-    struct TaskPromiseBase {
-        std::suspend_always initial_suspend() { return {}; }
+    struct TaskPromiseBase : PromiseAllocation {
+        std::suspend_always initial_suspend() {
+            MYX_COROUTINE_TRACE_EVENT(TaskCreated, this);
+            return {};
+        }
 
-        final_awaiter<T> final_suspend() noexcept { return {}; }
+        final_awaiter<T> final_suspend() noexcept {
+            MYX_COROUTINE_TRACE_EVENT(TaskFinished, this);
+            return {};
+        }
 
         void set_continuation(std::coroutine_handle<> continuation) noexcept {
             continuation_ = continuation;
         }
 
-        std::coroutine_handle<> get_continuation() const noexcept { return continuation_; }
+        void set_completion_hook(TaskCompletionHook *hook) noexcept { hook_ = hook; }
+
+        const std::stop_token &stop_token() const noexcept { return stop_token_; }
+
+        void set_stop_token(std::stop_token token) noexcept { stop_token_ = std::move(token); }
+
+        // A task started without a token of its own gets the one of whoever awaits it.
+        void inherit_stop_token(std::stop_token token) noexcept {
+            if (!stop_token_.stop_possible()) {
+                stop_token_ = std::move(token);
+            }
+        }
+
+        // The hook may destroy this coroutine, nothing of the promise is touched after it ran.
+        std::coroutine_handle<> get_continuation() const noexcept {
+            if (hook_ != nullptr) {
+                return hook_->on_complete_(hook_);
+            }
+            return continuation_;
+        }
 
         std::coroutine_handle<> continuation_{std::noop_coroutine()};
+        TaskCompletionHook *hook_ = nullptr;
+        std::stop_token stop_token_;
     };
 
+    // The stop token of the coroutine behind `handle`, an empty one unless it is a Task.
+    template<typename Promise>
+    std::stop_token stop_token_of(std::coroutine_handle<Promise> handle) noexcept {
+        if constexpr (requires { handle.promise().stop_token(); }) {
+            return handle.promise().stop_token();
+        } else {
+            return {};
+        }
+    }
+
     template<typename T = void>
     class TaskPromise final : public TaskPromiseBase<T> {
       public:
@@ -130,6 +177,7 @@ namespace detail {
 template<typename T>
 class Task {
   public:
+    using value_type = T;
     using promise_type = detail::TaskPromise<T>;
     using handle_type = std::coroutine_handle<promise_type>;
 
@@ -137,8 +185,7 @@ class Task {
 
     Task(const Task &) = delete;
 
-    // Task(Task &&task) : handle_{std::exchange(task.handle_, nullptr)} {}
-    Task(Task &&task) = delete;
+    Task(Task &&task) noexcept : handle_{std::exchange(task.handle_, nullptr)} {}
 
     Task &operator=(const Task &) = delete;
     Task &operator=(Task &&) = delete;
@@ -166,24 +213,34 @@ class Task {
 
     bool is_ready() { return handle_ == nullptr || handle_.done(); }
 
-    auto operator co_await() const & {
-        struct awaitable {
-            handle_type handle_;
-
-            bool await_ready() { return false; }
+    /// Makes `token` the task's stop token before it starts, it is handed down to every task
+    /// it awaits. Without one a task inherits the token of its awaiter.
+    void set_stop_token(std::stop_token token) noexcept {
+        handle_.promise().set_stop_token(std::move(token));
+    }
 
-            std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) {
-                handle_.promise().set_continuation(continuation);
-                return handle_;
-            }
+    auto operator co_await() const & { return Awaitable{handle_}; }
 
-            T await_resume() { return handle_.promise().get_result(); }
-        };
+  private:
+    // Not local to `operator co_await`, a local class cannot have member templates.
+    struct Awaitable {
+        handle_type handle_;
+
+        bool await_ready() { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> continuation) {
+            handle_.promise().inherit_stop_token(detail::stop_token_of(continuation));
+            handle_.promise().set_continuation(continuation);
+            MYX_COROUTINE_TRACE_EVENT(
+                TaskAwait, static_cast<detail::TaskPromiseBase<T> *>(&handle_.promise())
+            );
+            return handle_;
+        }
 
-        return awaitable{handle_};
-    }
+        T await_resume() { return handle_.promise().get_result(); }
+    };
 
-  private:
     handle_type handle_;
 };
 
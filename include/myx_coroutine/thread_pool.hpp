@@ -1,25 +1,70 @@
+#pragma once
+
 #include "concurrent_queue.hpp"
+#include "mpmc_queue.hpp"
+#include "small_function.hpp"
+#include "trace.hpp"
+#include "work_stealing_deque.hpp"
+#include <atomic>
+#include <coroutine>
 #include <cstddef>
-#include <functional>
+#include <cstdint>
+#include <memory>
+#include <random>
 #include <thread>
 #include <vector>
 
 namespace coroutine {
+
+namespace detail {
+    // Intrusive unit of work of the work-stealing queues. `run_` owns the job from the moment
+    // it is called, so heap-allocated jobs free themselves there.
+    struct PoolJob {
+        void (*run_)(PoolJob *) = nullptr;
+    };
+} // namespace detail
+
 class ThreadPool {
   public:
+    // Move-only, callables up to 48 bytes are stored inline.
+    using Function = SmallFunction<void(), 48>;
+
     struct Task {
-        std::function<void()> fn_ = nullptr;
+        Function fn_ = nullptr;
+    };
+
+    enum class Scheduling {
+        // All workers pull from one shared queue.
+        SharedQueue,
+        // Every worker owns a Chase-Lev deque, pops local work LIFO and steals FIFO from
+        // random victims when idle. Tasks pushed from outside the pool go to a shared
+        // lock-free injection ring, and spill into an unbounded locked queue when the ring is
+        // full, so pushing from outside never blocks.
+        WorkStealing,
     };
 
-    ThreadPool(std::size_t thread_count = 0) {
+    ThreadPool(std::size_t thread_count = 0, Scheduling scheduling = Scheduling::SharedQueue)
+        : scheduling_(scheduling) {
         thread_count_ = (thread_count == 0 ? std::thread::hardware_concurrency() : thread_count);
         thread_pool_.reserve(thread_count_);
+        if (scheduling_ == Scheduling::WorkStealing) {
+            workers_.reserve(thread_count_);
+            for (std::size_t i = 0; i < thread_count_; ++i) {
+                workers_.emplace_back(std::make_unique<Worker>(this));
+            }
+            for (std::size_t i = 0; i < thread_count_; ++i) {
+                thread_pool_.emplace_back([this, i]() { steal_loop(i); });
+            }
+            return;
+        }
         auto do_task = [this](std::size_t id) {
             while (true) {
                 Task task;
                 if (task_queue_.pop(task)) {
                     if (task.fn_) {
+                        MYX_COROUTINE_TRACE_EVENT(JobBegin, nullptr);
                         task.fn_();
+                        MYX_COROUTINE_TRACE_EVENT(JobEnd, nullptr);
                     }
                 }
                 if (stop_) {
@@ -32,20 +77,174 @@ class ThreadPool {
         }
     }
 
-    void push_task(std::function<void()> fn) { task_queue_.push(Task{fn}); }
+    template<typename F>
+    void push_task(F &&fn) {
+        if (scheduling_ == Scheduling::WorkStealing) {
+            push_job(new HeapTask(Function(std::forward<F>(fn))));
+            return;
+        }
+        task_queue_.push(Task{Function(std::forward<F>(fn))});
+    }
+
+    /// `co_await pool.schedule()` suspends the current coroutine and resumes it on one of the
+    /// workers.
+    ///
+    /// In work-stealing mode the awaiter itself, which lives in the coroutine frame, is the
+    /// queued node, so a hop costs no allocation, and no lock unless it comes from outside the
+    /// pool while the injection ring is full.
+    class ScheduleAwaiter : private detail::PoolJob {
+      public:
+        explicit ScheduleAwaiter(ThreadPool *pool) noexcept : PoolJob{&resume}, pool_(pool) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            pool_->push_job(this);
+        }
+
+        void await_resume() const noexcept {}
+
+      private:
+        static void resume(PoolJob *job) { static_cast<ScheduleAwaiter *>(job)->handle_.resume(); }
+
+        ThreadPool *pool_;
+        std::coroutine_handle<> handle_;
+    };
+
+    [[nodiscard]]
+    ScheduleAwaiter schedule() noexcept {
+        return ScheduleAwaiter{this};
+    }
 
     ~ThreadPool() {
         stop_ = true;
         task_queue_.stop();
+        idle_.notify_all();
         for (auto &thread : thread_pool_) {
             thread.join();
         }
     }
 
   private:
+    struct Worker {
+        explicit Worker(ThreadPool *pool) : pool_(pool) {}
+
+        ThreadPool *pool_;
+        WorkStealingDeque<detail::PoolJob *> deque_;
+    };
+
+    struct HeapTask : detail::PoolJob {
+        explicit HeapTask(Function fn) : PoolJob{&run}, task_{std::move(fn)} {}
+
+        static void run(PoolJob *job) {
+            std::unique_ptr<HeapTask> self(static_cast<HeapTask *>(job));
+            if (self->task_.fn_) {
+                self->task_.fn_();
+            }
+        }
+
+        Task task_;
+    };
+
+    void push_job(detail::PoolJob *job) {
+        if (scheduling_ == Scheduling::SharedQueue) {
+            // The closure only captures the job pointer, so it is stored inline.
+            task_queue_.push(Task{[job]() { job->run_(job); }});
+            return;
+        }
+        Worker *worker = current_worker_;
+        if (worker != nullptr && worker->pool_ == this) {
+            worker->deque_.push(job);
+        } else {
+            inject(job);
+        }
+        idle_.notify_one();
+    }
+
+    // The count is raised before the push, so a worker that sees it zero may skip the lock:
+    // the job it missed is followed by an `idle_.notify_one()`.
+    void inject(detail::PoolJob *job) {
+        if (injection_queue_.try_push(std::move(job))) {
+            return;
+        }
+        overflow_size_.fetch_add(1, std::memory_order_relaxed);
+        overflow_queue_.push(std::move(job));
+    }
+
+    bool pop_injected(detail::PoolJob *&job) {
+        if (injection_queue_.try_pop(job)) {
+            return true;
+        }
+        if (overflow_size_.load(std::memory_order_relaxed) > 0 && overflow_queue_.try_pop(job)) {
+            overflow_size_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    detail::PoolJob *find_job(std::size_t id, std::minstd_rand &rng) {
+        detail::PoolJob *job = nullptr;
+        if (workers_[id]->deque_.pop(job)) {
+            return job;
+        }
+        if (pop_injected(job)) {
+            return job;
+        }
+        std::size_t start = rng() % thread_count_;
+        for (std::size_t i = 0; i < thread_count_; ++i) {
+            std::size_t victim = (start + i) % thread_count_;
+            if (victim != id && workers_[victim]->deque_.steal(job)) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    // `run_` may free the job, its address only tags the trace events.
+    static void run_job(detail::PoolJob *job) {
+        MYX_COROUTINE_TRACE_EVENT(JobBegin, job);
+        job->run_(job);
+        MYX_COROUTINE_TRACE_EVENT(JobEnd, job);
+    }
+
+    void steal_loop(std::size_t id) {
+        current_worker_ = workers_[id].get();
+        std::minstd_rand rng(static_cast<std::uint32_t>(id) + 1);
+        while (true) {
+            if (detail::PoolJob *job = find_job(id, rng)) {
+                run_job(job);
+                continue;
+            }
+            // Announce ourselves before the final re-check, so that a producer either sees a
+            // sleeper and wakes us, or we see its task.
+            auto epoch = idle_.prepare();
+            if (detail::PoolJob *job = find_job(id, rng)) {
+                idle_.cancel();
+                run_job(job);
+                continue;
+            }
+            if (stop_) {
+                idle_.cancel();
+                break;
+            }
+            idle_.wait(epoch);
+        }
+        current_worker_ = nullptr;
+    }
+
     std::size_t thread_count_;
+    Scheduling scheduling_;
     std::vector<std::thread> thread_pool_;
     ConcurrentQueue<Task> task_queue_;
     std::atomic<bool> stop_ = false;
+
+    // Work-stealing mode only.
+    std::vector<std::unique_ptr<Worker>> workers_;
+    BoundedMpmcQueue<detail::PoolJob *> injection_queue_{4096};
+    ConcurrentQueue<detail::PoolJob *> overflow_queue_;
+    std::atomic<std::size_t> overflow_size_ = 0;
+    detail::Parker idle_;
+    static inline thread_local Worker *current_worker_ = nullptr;
 };
 } // namespace coroutine
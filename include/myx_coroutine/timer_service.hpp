@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <myx_coroutine/cancellation.hpp>
+#include <myx_coroutine/timer_wheel.hpp>
+#include <stop_token>
+#include <thread>
+
+namespace myx_coroutine {
+
+/// One thread driving a TimerWheel for every sleeping coroutine:
+///
+///     co_await sleep_for(10ms);
+///
+/// Timers are handed to the timer thread through a lock-free stack, the first push after
+/// the thread drained it also wakes the thread up. Expired timers are fired in batches, a
+/// wheel slot at a time, and resume their coroutines on the timer thread; a coroutine with
+/// more than a little work to do should hop to a pool with `co_await pool.schedule()`.
+///
+/// A sleep in a Task whose stop token gets triggered is taken out of the wheel by the timer
+/// thread, and `co_await` throws OperationCancelled.
+///
+/// Timers still pending when the service is destroyed are never fired.
+class TimerService {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    class SleepAwaiter : detail::TimerNode, detail::CancellableOperation {
+      public:
+        SleepAwaiter(TimerService &service, Clock::time_point deadline) noexcept
+            : CancellableOperation(&request_cancel, &service)
+            , service_(service)
+            , wake_at_(deadline) {}
+
+        bool await_ready() const noexcept { return wake_at_ <= Clock::now(); }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::stop_token token = detail::stop_token_of(handle);
+            if (!prepare(token)) {
+                return false;
+            }
+            handle_ = handle;
+            fire_ = &on_fire;
+            // The timer thread owns the awaiter from here on, without a stop token it may
+            // already be resumed and gone when `schedule` returns.
+            bool must_arm = cancellable();
+            service_.schedule(this, wake_at_);
+            return !must_arm || arm(token);
+        }
+
+        void await_resume() const {
+            if (cancelled()) {
+                throw OperationCancelled{};
+            }
+        }
+
+      private:
+        friend class TimerService;
+
+        static void on_fire(detail::TimerNode *node) noexcept {
+            auto *self = static_cast<SleepAwaiter *>(node);
+            if (self->complete()) {
+                self->handle_.resume();
+            }
+        }
+
+        TimerService &service_;
+        Clock::time_point wake_at_;
+        std::coroutine_handle<> handle_;
+    };
+
+    explicit TimerService(Clock::duration resolution = std::chrono::milliseconds(1));
+
+    TimerService(const TimerService &) = delete;
+    TimerService &operator=(const TimerService &) = delete;
+
+    ~TimerService();
+
+    [[nodiscard]]
+    SleepAwaiter sleep_until(Clock::time_point deadline) noexcept {
+        return SleepAwaiter{*this, deadline};
+    }
+
+    [[nodiscard]]
+    SleepAwaiter sleep_for(Clock::duration duration) noexcept {
+        return SleepAwaiter{*this, Clock::now() + duration};
+    }
+
+    /// Low level entry point: calls `node->fire_` on the timer thread once `deadline` has
+    /// passed. Safe to call from any thread.
+    void schedule(detail::TimerNode *node, Clock::time_point deadline) noexcept;
+
+    // Timers scheduled and not fired yet, brought up to date after every batch.
+    std::size_t pending() const noexcept { return pending_.load(std::memory_order_relaxed); }
+
+    // Started on first use, lives until the end of the program.
+    static TimerService &get_default();
+
+  private:
+    // Rounded up, a timer never fires early.
+    std::uint64_t to_tick(Clock::time_point time) const noexcept;
+
+    Clock::time_point to_time(std::uint64_t tick) const noexcept;
+
+    void run();
+
+    void drain_incoming() noexcept;
+
+    static void request_cancel(void *owner, detail::CancellableOperation *operation) noexcept;
+
+    // Resumes the sleeps whose cancel requests were taken off `cancels_`.
+    void cancel(detail::CancellableOperation *operations) noexcept;
+
+    const Clock::time_point epoch_;
+    const Clock::duration resolution_;
+    detail::TimerWheel wheel_;
+    // Timers scheduled from any thread, linked through `next_`, not yet in the wheel.
+    std::atomic<detail::TimerNode *> incoming_{nullptr};
+    detail::CancelQueue cancels_;
+    std::atomic<std::size_t> pending_{0};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+[[nodiscard]]
+inline TimerService::SleepAwaiter sleep_until(TimerService::Clock::time_point deadline) noexcept {
+    return TimerService::get_default().sleep_until(deadline);
+}
+
+template<typename Rep, typename Period>
+[[nodiscard]]
+TimerService::SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> duration) noexcept {
+    return TimerService::get_default().sleep_for(
+        std::chrono::ceil<TimerService::Clock::duration>(duration)
+    );
+}
+} // namespace myx_coroutine
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace myx_coroutine {
+namespace detail {
+    // Intrusive timer, usually part of an awaiter. `fire_` is called once the wheel reaches
+    // `deadline_` and owns the node from then on.
+    struct TimerNode {
+        void (*fire_)(TimerNode *) noexcept = nullptr;
+        std::uint64_t deadline_ = 0;
+        TimerNode *prev_ = nullptr;
+        TimerNode *next_ = nullptr;
+        std::uint8_t level_ = 0;
+        std::uint8_t slot_ = 0;
+    };
+
+    /// Hierarchical timing wheel over abstract ticks, not thread safe.
+    ///
+    /// Eight levels of 256 slots cover the whole 64-bit tick range: a timer sits at the
+    /// level of the highest base-256 digit in which its deadline differs from the current
+    /// tick. When the current tick reaches the start of a slot above level 0, that slot is
+    /// cascaded one or more levels down; level 0 slots are expired whole. Insert and remove
+    /// are O(1) list operations. A bitmap per level lets `advance` jump straight over empty
+    /// stretches, so sparse timers cost no more than dense ones.
+    class TimerWheel {
+      public:
+        static constexpr std::uint64_t kNever = ~std::uint64_t{0};
+
+        explicit TimerWheel(std::uint64_t now = 0) noexcept : current_(now) {}
+
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel &operator=(const TimerWheel &) = delete;
+
+        // A deadline in the past fires on the next `advance`.
+        void insert(TimerNode *node) noexcept;
+
+        void remove(TimerNode *node) noexcept;
+
+        /// Fires every timer due at or before `now`, a slot at a time. Timers inserted by
+        /// `fire_` callbacks that are already due fire within the same call. Returns the
+        /// number of timers fired.
+        std::size_t advance(std::uint64_t now);
+
+        /// The next tick at which `advance` has something to do, `kNever` if the wheel is
+        /// empty. Only a lower bound for timers above level 0, which need cascading first.
+        std::uint64_t next_event() const noexcept;
+
+        std::size_t size() const noexcept { return size_; }
+
+        // The next tick to be processed.
+        std::uint64_t current() const noexcept { return current_; }
+
+      private:
+        static constexpr int kLevels = 8;
+        static constexpr int kSlotBits = 8;
+        static constexpr int kSlots = 1 << kSlotBits;
+
+        struct Level {
+            std::array<TimerNode *, kSlots> slots_{};
+            std::array<std::uint64_t, kSlots / 64> occupied_{};
+        };
+
+        static int digit(std::uint64_t tick, int level) noexcept {
+            return static_cast<int>((tick >> (level * kSlotBits)) & (kSlots - 1));
+        }
+
+        void link(TimerNode *node) noexcept;
+
+        TimerNode *take_slot(int level, int slot) noexcept;
+
+        // First occupied slot at `level` at or after `from`, -1 if none.
+        int find_slot(int level, int from) const noexcept;
+
+        std::array<Level, kLevels> levels_{};
+        std::uint64_t current_;
+        std::size_t size_ = 0;
+    };
+} // namespace detail
+} // namespace myx_coroutine
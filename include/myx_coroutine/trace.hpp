@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#if MYX_COROUTINE_TRACE
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+namespace myx_coroutine {
+namespace trace {
+    enum class Event : std::uint8_t {
+        // A Task's promise was constructed, its frame exists but has not run yet.
+        TaskCreated,
+        // A Task is about to be resumed by the coroutine awaiting it.
+        TaskAwait,
+        // A Task reached its final suspend point.
+        TaskFinished,
+        // A ThreadPool worker starts and finishes running a job.
+        JobBegin,
+        JobEnd,
+    };
+
+    /// Writes every recorded event as Chrome trace event JSON, for chrome://tracing and
+    /// ui.perfetto.dev. Task lifetimes become async slices keyed by the promise address, awaits
+    /// instant events on the awaiting thread and pool jobs slices on their worker. Without
+    /// `MYX_COROUTINE_TRACE` the trace is empty.
+    ///
+    /// May be called while other threads record, events being overwritten meanwhile are left out.
+    void write_chrome_trace(std::ostream &out);
+
+    bool write_chrome_trace(const char *path);
+
+#if MYX_COROUTINE_TRACE
+    namespace detail {
+        // rdtsc where available, a few cycles instead of a clock_gettime call. Converted to
+        // steady_clock time when the trace is written.
+        inline std::uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(
+                std::chrono::steady_clock::now().time_since_epoch().count()
+            );
+#endif
+        }
+
+        // A seqlock per slot: `seq_` is zeroed before the fields are written and set to the
+        // event's position afterwards, so a reader that sees the same position before and
+        // after copying has a consistent record.
+        struct Slot {
+            std::atomic<std::uint64_t> seq_{0};
+            std::atomic<std::uint64_t> ticks_{0};
+            std::atomic<const void *> id_{nullptr};
+            // Thread id in the upper bits, the event in the lowest byte.
+            std::atomic<std::uint64_t> meta_{0};
+        };
+
+        /// Events of one thread, the oldest are overwritten once it is full. Only the owning
+        /// thread writes, a ring goes to another thread once its owner exited.
+        class Ring {
+          public:
+            static constexpr std::size_t kCapacity = std::size_t{1} << 14;
+
+            void push(Event event, const void *id) noexcept {
+                Slot &slot = slots_[head_ & (kCapacity - 1)];
+                slot.seq_.store(0, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.ticks_.store(ticks(), std::memory_order_relaxed);
+                slot.id_.store(id, std::memory_order_relaxed);
+                slot.meta_.store(
+                    (std::uint64_t{tid_} << 8) | static_cast<std::uint8_t>(event),
+                    std::memory_order_relaxed
+                );
+                slot.seq_.store(++head_, std::memory_order_release);
+            }
+
+            const std::array<Slot, kCapacity> &slots() const noexcept { return slots_; }
+
+            void set_tid(std::uint32_t tid) noexcept { tid_ = tid; }
+
+          private:
+            std::uint32_t tid_ = 0;
+            // Positions keep counting across owners, so they order the whole ring.
+            std::uint64_t head_ = 0;
+            std::array<Slot, kCapacity> slots_;
+        };
+
+        inline constinit thread_local Ring *tls_ring = nullptr;
+
+        // Takes a ring from the registry for the calling thread, nullptr once it is exiting.
+        Ring *acquire_ring() noexcept;
+    } // namespace detail
+
+    inline void record(Event event, const void *id) noexcept {
+        detail::Ring *ring = detail::tls_ring;
+        if (ring == nullptr) [[unlikely]] {
+            ring = detail::acquire_ring();
+            if (ring == nullptr) {
+                return;
+            }
+        }
+        ring->push(event, id);
+    }
+#endif
+} // namespace trace
+} // namespace myx_coroutine
+
+#if MYX_COROUTINE_TRACE
+#define MYX_COROUTINE_TRACE_EVENT(event, id)                                                       \
+    ::myx_coroutine::trace::record(::myx_coroutine::trace::Event::event, id)
+#else
+#define MYX_COROUTINE_TRACE_EVENT(event, id) ((void)0)
+#endif
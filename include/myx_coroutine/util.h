@@ -4,4 +4,14 @@ namespace myx_coroutine {
 
 #define MESSAGE_ASSERT(expr, msg) assert(expr)
 
+// Unit plays the role of a simplest type in case we couldn't
+// use void directly.
+//
+// User shouldn't use this directly.
+struct Unit {
+    constexpr bool operator==(const Unit &) const { return true; }
+
+    constexpr bool operator!=(const Unit &) const { return false; }
+};
+
 }
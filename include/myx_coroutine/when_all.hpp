@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <myx_coroutine/task.hpp>
+#include <myx_coroutine/util.h>
+#include <ranges>
+#include <stop_token>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace myx_coroutine {
+
+namespace detail {
+    template<typename T>
+    using when_all_value_t = std::conditional_t<std::is_void_v<T>, Unit, T>;
+
+    // Counts down from `count + 1`: one arrival per child plus one for the parent once it has
+    // started them all, so a child finishing early can never resume a parent that is still
+    // inside `await_suspend`.
+    class WhenAllCounter {
+      public:
+        explicit WhenAllCounter(std::size_t count) noexcept : count_(count + 1) {}
+
+        // Parent side, returns whether the parent has to stay suspended.
+        bool try_suspend(std::coroutine_handle<> parent) noexcept {
+            parent_ = parent;
+            return count_.fetch_sub(1, std::memory_order_acq_rel) > 1;
+        }
+
+        // Child side, the last arrival resumes the parent.
+        std::coroutine_handle<> arrive() noexcept {
+            if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                return parent_;
+            }
+            return std::noop_coroutine();
+        }
+
+      private:
+        std::atomic<std::size_t> count_;
+        std::coroutine_handle<> parent_;
+    };
+
+    struct WhenAllHook : TaskCompletionHook {
+        explicit WhenAllHook(WhenAllCounter *counter = nullptr) noexcept
+            : TaskCompletionHook{&on_complete}, counter_(counter) {}
+
+        static std::coroutine_handle<> on_complete(TaskCompletionHook *hook) noexcept {
+            return static_cast<WhenAllHook *>(hook)->counter_->arrive();
+        }
+
+        WhenAllCounter *counter_;
+    };
+
+    template<typename T>
+    when_all_value_t<T> take_result(Task<T> &task) {
+        if constexpr (std::is_void_v<T>) {
+            std::move(task).promise().get_result();
+            return Unit{};
+        } else {
+            return std::move(task).promise().get_result();
+        }
+    }
+
+    template<typename... Ts>
+    class WhenAllAwaiter {
+      public:
+        explicit WhenAllAwaiter(Task<Ts>... tasks)
+            : tasks_(std::move(tasks)...), counter_(sizeof...(Ts)) {}
+
+        WhenAllAwaiter(const WhenAllAwaiter &) = delete;
+        WhenAllAwaiter &operator=(const WhenAllAwaiter &) = delete;
+
+        bool await_ready() const noexcept { return sizeof...(Ts) == 0; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> parent) {
+            start(stop_token_of(parent), std::index_sequence_for<Ts...>{});
+            return counter_.try_suspend(parent);
+        }
+
+        std::tuple<when_all_value_t<Ts>...> await_resume() {
+            return std::apply(
+                [](auto &...tasks) {
+                    return std::tuple<when_all_value_t<Ts>...>{take_result(tasks)...};
+                },
+                tasks_
+            );
+        }
+
+      private:
+        template<std::size_t... Is>
+        void start(const std::stop_token &token, std::index_sequence<Is...>) {
+            ((hooks_[Is].counter_ = &counter_,
+              std::get<Is>(tasks_).promise().set_completion_hook(&hooks_[Is]),
+              std::get<Is>(tasks_).promise().inherit_stop_token(token),
+              std::get<Is>(tasks_).resume()),
+             ...);
+        }
+
+        std::tuple<Task<Ts>...> tasks_;
+        WhenAllCounter counter_;
+        std::array<WhenAllHook, sizeof...(Ts)> hooks_;
+    };
+
+    template<typename T>
+    class WhenAllRangeAwaiter {
+      public:
+        explicit WhenAllRangeAwaiter(std::vector<Task<T>> tasks)
+            : tasks_(std::move(tasks)), counter_(tasks_.size()) {}
+
+        WhenAllRangeAwaiter(const WhenAllRangeAwaiter &) = delete;
+        WhenAllRangeAwaiter &operator=(const WhenAllRangeAwaiter &) = delete;
+
+        bool await_ready() const noexcept { return tasks_.empty(); }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> parent) {
+            std::stop_token token = stop_token_of(parent);
+            hooks_.assign(tasks_.size(), WhenAllHook{&counter_});
+            for (std::size_t i = 0; i < tasks_.size(); ++i) {
+                tasks_[i].promise().set_completion_hook(&hooks_[i]);
+                tasks_[i].promise().inherit_stop_token(token);
+                tasks_[i].resume();
+            }
+            return counter_.try_suspend(parent);
+        }
+
+        auto await_resume() {
+            if constexpr (std::is_void_v<T>) {
+                for (auto &task : tasks_) {
+                    std::move(task).promise().get_result();
+                }
+            } else {
+                std::vector<T> results;
+                results.reserve(tasks_.size());
+                for (auto &task : tasks_) {
+                    results.push_back(std::move(task).promise().get_result());
+                }
+                return results;
+            }
+        }
+
+      private:
+        std::vector<Task<T>> tasks_;
+        WhenAllCounter counter_;
+        std::vector<WhenAllHook> hooks_;
+    };
+
+    template<typename R>
+    using range_task_value_t = typename std::ranges::range_value_t<R>::value_type;
+} // namespace detail
+
+/// `co_await when_all(a(), b(), ...)` starts every task before suspending the caller and
+/// resumes it once the last one has finished, so the wait is as long as the slowest child
+/// rather than the sum of all of them.
+///
+/// Children are started on the awaiting thread and finish wherever they finish; the caller
+/// resumes on the thread of the last one. The result is a tuple with `Unit` in place of
+/// `void`. If children threw, the exception of the first of them (in argument order) is
+/// rethrown once all have finished. Children without a stop token of their own get the
+/// caller's. Bookkeeping lives in the awaiter, which lives in the
+/// caller's frame, so nothing is allocated per child.
+template<typename... Ts>
+[[nodiscard]]
+detail::WhenAllAwaiter<Ts...> when_all(Task<Ts>... tasks) {
+    return detail::WhenAllAwaiter<Ts...>{std::move(tasks)...};
+}
+
+/// `when_all` over a range of `Task<T>`, the tasks are moved out of the range. Yields a
+/// `std::vector<T>` in range order, or nothing for `Task<void>`. The hooks of all children
+/// share one allocation.
+template<std::ranges::input_range R>
+[[nodiscard]]
+detail::WhenAllRangeAwaiter<detail::range_task_value_t<R>> when_all(R &&range) {
+    using T = detail::range_task_value_t<R>;
+    std::vector<Task<T>> tasks;
+    if constexpr (std::ranges::sized_range<R>) {
+        tasks.reserve(std::ranges::size(range));
+    }
+    for (auto &task : range) {
+        tasks.push_back(std::move(task));
+    }
+    return detail::WhenAllRangeAwaiter<T>{std::move(tasks)};
+}
+} // namespace myx_coroutine
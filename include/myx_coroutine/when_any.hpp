@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <limits>
+#include <myx_coroutine/task.hpp>
+#include <myx_coroutine/util.h>
+#include <myx_coroutine/when_all.hpp>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace myx_coroutine {
+
+template<typename T>
+struct WhenAnyResult {
+    // Position of the first task to finish.
+    std::size_t index_;
+    detail::when_all_value_t<T> value_;
+};
+
+namespace detail {
+    // Shared by the awaiting parent and all children. The parent goes away as soon as the
+    // first child finishes while the others keep running, so the children and their hooks
+    // live here, reference counted, and the last one to finish frees everything. The
+    // children share a stop source that the winner triggers and that follows the parent's
+    // token.
+    template<typename T>
+    class WhenAnyState {
+        static constexpr std::size_t kNoWinner = std::numeric_limits<std::size_t>::max();
+
+        struct Hook : TaskCompletionHook {
+            Hook() noexcept : TaskCompletionHook{&on_complete} {}
+
+            static std::coroutine_handle<> on_complete(TaskCompletionHook *hook) noexcept {
+                auto *self = static_cast<Hook *>(hook);
+                return self->state_->complete(self->index_);
+            }
+
+            WhenAnyState *state_ = nullptr;
+            std::size_t index_ = 0;
+        };
+
+        struct ForwardStop {
+            WhenAnyState *state_;
+
+            void operator()() const noexcept { state_->stop_.request_stop(); }
+        };
+
+      public:
+        explicit WhenAnyState(std::vector<Task<T>> tasks)
+            : tasks_(std::move(tasks)), hooks_(tasks_.size()), refs_(tasks_.size() + 1) {
+            for (std::size_t i = 0; i < tasks_.size(); ++i) {
+                hooks_[i].state_ = this;
+                hooks_[i].index_ = i;
+                tasks_[i].promise().set_completion_hook(&hooks_[i]);
+                tasks_[i].promise().inherit_stop_token(stop_.get_token());
+            }
+        }
+
+        bool start(std::coroutine_handle<> parent, const std::stop_token &token) {
+            parent_ = parent;
+            if (token.stop_possible()) {
+                forward_stop_.emplace(token, ForwardStop{this});
+            }
+            for (auto &task : tasks_) {
+                task.resume();
+            }
+            // The parent's arrival at the gate, the winner's is the other one.
+            return gate_.fetch_sub(1, std::memory_order_acq_rel) > 1;
+        }
+
+        WhenAnyResult<T> take_result() {
+            std::size_t index = winner_.load(std::memory_order_acquire);
+            return WhenAnyResult<T>{index, detail::take_result(tasks_[index])};
+        }
+
+        void release() noexcept {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // Every child is parked at its final suspend point, destroying them is fine.
+                delete this;
+            }
+        }
+
+      private:
+        std::coroutine_handle<> complete(std::size_t index) noexcept {
+            std::coroutine_handle<> next = std::noop_coroutine();
+            std::size_t expected = kNoWinner;
+            if (winner_.compare_exchange_strong(expected, index, std::memory_order_acq_rel)) {
+                // The losers' pending timer, I/O and channel operations give up now.
+                stop_.request_stop();
+                if (gate_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    next = parent_;
+                }
+            }
+            // May destroy the calling coroutine, the parent still holds a reference if it is
+            // about to be resumed.
+            release();
+            return next;
+        }
+
+        std::vector<Task<T>> tasks_;
+        std::vector<Hook> hooks_;
+        std::atomic<std::size_t> refs_;
+        std::atomic<std::size_t> winner_{kNoWinner};
+        std::atomic<int> gate_{2};
+        std::coroutine_handle<> parent_;
+        std::stop_source stop_;
+        std::optional<std::stop_callback<ForwardStop>> forward_stop_;
+    };
+
+    template<typename T>
+    class WhenAnyAwaiter {
+      public:
+        explicit WhenAnyAwaiter(std::vector<Task<T>> tasks) {
+            if (tasks.empty()) {
+                throw std::invalid_argument("when_any needs at least one task");
+            }
+            state_ = new WhenAnyState<T>(std::move(tasks));
+        }
+
+        WhenAnyAwaiter(const WhenAnyAwaiter &) = delete;
+        WhenAnyAwaiter &operator=(const WhenAnyAwaiter &) = delete;
+
+        ~WhenAnyAwaiter() {
+            if (started_) {
+                state_->release();
+            } else {
+                // Never awaited, no child holds a reference.
+                delete state_;
+            }
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        bool await_suspend(std::coroutine_handle<Promise> parent) {
+            started_ = true;
+            return state_->start(parent, stop_token_of(parent));
+        }
+
+        WhenAnyResult<T> await_resume() { return state_->take_result(); }
+
+      private:
+        WhenAnyState<T> *state_;
+        bool started_ = false;
+    };
+} // namespace detail
+
+/// `co_await when_any(a(), b(), ...)` starts every task and resumes the caller as soon as
+/// the first one finishes, with its index and result (its exception is rethrown instead).
+///
+/// Stop is then requested on the other tasks' shared token (which also follows the caller's),
+/// so their timer, I/O and channel waits end with OperationCancelled; work that does not
+/// look at the token keeps running. Their results are dropped and their frames are freed
+/// when the last of them finishes. All tasks share one allocation for this bookkeeping.
+template<typename T, typename... Ts>
+    requires(std::is_same_v<T, Ts> && ...)
+[[nodiscard]]
+detail::WhenAnyAwaiter<T> when_any(Task<T> first, Task<Ts>... rest) {
+    std::vector<Task<T>> tasks;
+    tasks.reserve(1 + sizeof...(Ts));
+    tasks.push_back(std::move(first));
+    (tasks.push_back(std::move(rest)), ...);
+    return detail::WhenAnyAwaiter<T>{std::move(tasks)};
+}
+
+/// `when_any` over a non-empty range of `Task<T>`, the tasks are moved out of the range.
+template<std::ranges::input_range R>
+[[nodiscard]]
+detail::WhenAnyAwaiter<detail::range_task_value_t<R>> when_any(R &&range) {
+    using T = detail::range_task_value_t<R>;
+    std::vector<Task<T>> tasks;
+    for (auto &task : range) {
+        tasks.push_back(std::move(task));
+    }
+    return detail::WhenAnyAwaiter<T>{std::move(tasks)};
+}
+} // namespace myx_coroutine
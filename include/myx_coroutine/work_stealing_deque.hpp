@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace coroutine {
+
+/// Chase-Lev work-stealing deque (Lê et al., "Correct and Efficient Work-Stealing for Weak
+/// Memory Models", PPoPP'13).
+///
+/// The owner thread calls `push` / `pop` on the bottom end (LIFO), any other thread may call
+/// `steal` on the top end (FIFO). Elements are copied in and out of atomic slots, so `T` is
+/// expected to be a small trivially copyable type, typically a pointer.
+template<typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque only holds trivial types");
+
+    struct Buffer {
+        explicit Buffer(std::int64_t capacity)
+            : capacity_(capacity)
+            , mask_(capacity - 1)
+            , slots_(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+        T load(std::int64_t i) const noexcept {
+            return slots_[i & mask_].load(std::memory_order_relaxed);
+        }
+
+        void store(std::int64_t i, T x) noexcept {
+            slots_[i & mask_].store(x, std::memory_order_relaxed);
+        }
+
+        Buffer *grow(std::int64_t bottom, std::int64_t top) const {
+            auto *buffer = new Buffer(capacity_ * 2);
+            for (std::int64_t i = top; i < bottom; ++i) {
+                buffer->store(i, load(i));
+            }
+            return buffer;
+        }
+
+        std::int64_t capacity_;
+        std::int64_t mask_;
+        std::unique_ptr<std::atomic<T>[]> slots_;
+    };
+
+  public:
+    // capacity must be a power of two.
+    explicit WorkStealingDeque(std::int64_t capacity = 256) : buffer_(new Buffer(capacity)) {}
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    ~WorkStealingDeque() { delete buffer_.load(std::memory_order_relaxed); }
+
+    /// Owner only.
+    void push(T x) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+        if (b - t > buffer->capacity_ - 1) {
+            // Thieves may still be reading from the old buffer, keep it alive until the deque
+            // itself goes away.
+            retired_.emplace_back(buffer);
+            buffer = buffer->grow(b, t);
+            buffer_.store(buffer, std::memory_order_release);
+        }
+        buffer->store(b, x);
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    /// Owner only, takes the most recently pushed element.
+    bool pop(T &x) {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Buffer *buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            // Empty.
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        x = buffer->load(b);
+        if (t == b) {
+            // Last element, race against thieves for it.
+            bool won = top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+            );
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /// Any thread, takes the oldest element.
+    bool steal(T &x) {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Buffer *buffer = buffer_.load(std::memory_order_acquire);
+        T value = buffer->load(t);
+        if (!top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+            )) {
+            return false;
+        }
+        x = value;
+        return true;
+    }
+
+    /// Approximate when called from a thief.
+    std::size_t size() const noexcept {
+        std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+  private:
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    alignas(64) std::atomic<Buffer *> buffer_;
+    std::vector<std::unique_ptr<Buffer>> retired_;
+};
+} // namespace coroutine
@@ -0,0 +1,56 @@
+#include <myx_coroutine/async_condition_variable.hpp>
+
+namespace myx_coroutine {
+
+void AsyncConditionVariable::notify(std::size_t count) noexcept {
+    // Acquire pairs with the previous drainer's release, the private list is ours after it.
+    if (pending_.fetch_add(count, std::memory_order_acq_rel) != 0) {
+        return;
+    }
+    std::size_t batch = count;
+    while (true) {
+        // Only waiters that pushed themselves before the notification are owed a wake-up,
+        // a notify with nobody waiting is lost.
+        collect();
+        std::size_t wake = batch;
+        while (waiters_ != nullptr && wake != 0) {
+            detail::AsyncWaiter *waiter = waiters_;
+            waiters_ = waiter->next_;
+            if (batch < kAll) {
+                --wake;
+            }
+            requeue(waiter);
+        }
+        if (waiters_ == nullptr) {
+            waiters_tail_ = nullptr;
+        }
+        std::size_t left = pending_.fetch_sub(batch, std::memory_order_acq_rel) - batch;
+        if (left == 0) {
+            return;
+        }
+        batch = left;
+    }
+}
+
+void AsyncConditionVariable::collect() noexcept {
+    detail::AsyncWaiter *stack = stack_.exchange(nullptr, std::memory_order_acquire);
+    if (stack == nullptr) {
+        return;
+    }
+    detail::AsyncWaiter *tail = stack;
+    detail::AsyncWaiter *list = detail::reverse_waiters(stack);
+    if (waiters_ == nullptr) {
+        waiters_ = list;
+    } else {
+        waiters_tail_->next_ = list;
+    }
+    waiters_tail_ = tail;
+}
+
+void AsyncConditionVariable::requeue(detail::AsyncWaiter *waiter) noexcept {
+    AsyncMutex &mutex = static_cast<WaitAwaiter *>(waiter)->mutex_;
+    if (!mutex.lock_or_enqueue(waiter)) {
+        waiter->handle_.resume();
+    }
+}
+} // namespace myx_coroutine
@@ -0,0 +1,39 @@
+#include <myx_coroutine/async_mutex.hpp>
+
+namespace myx_coroutine {
+
+bool AsyncMutex::lock_or_enqueue(detail::AsyncWaiter *waiter) noexcept {
+    std::uintptr_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+        if (state == kNotLocked) {
+            if (state_.compare_exchange_weak(
+                    state, kLockedNoWaiters, std::memory_order_acquire, std::memory_order_relaxed
+                )) {
+                return false;
+            }
+            continue;
+        }
+        waiter->next_ = reinterpret_cast<detail::AsyncWaiter *>(state);
+        // Release, so the holder that pops us sees the handle.
+        if (state_.compare_exchange_weak(
+                state, reinterpret_cast<std::uintptr_t>(waiter), std::memory_order_release,
+                std::memory_order_relaxed
+            )) {
+            return true;
+        }
+    }
+}
+
+void AsyncMutex::unlock_slow() noexcept {
+    detail::AsyncWaiter *next = waiters_;
+    if (next == nullptr) {
+        // The CAS in unlock failed, so the stack is not empty and only the holder can take
+        // it.
+        std::uintptr_t stack = state_.exchange(kLockedNoWaiters, std::memory_order_acquire);
+        next = detail::reverse_waiters(reinterpret_cast<detail::AsyncWaiter *>(stack));
+    }
+    waiters_ = next->next_;
+    // Still locked, the mutex now belongs to `next`.
+    next->handle_.resume();
+}
+} // namespace myx_coroutine
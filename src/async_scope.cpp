@@ -0,0 +1,40 @@
+#include <myx_coroutine/async_scope.hpp>
+#include <myx_coroutine/detached_task.hpp>
+#include <myx_coroutine/util.h>
+#include <utility>
+
+namespace myx_coroutine {
+
+AsyncScope::~AsyncScope() {
+    MESSAGE_ASSERT(
+        count_.load(std::memory_order_acquire) == 1, "AsyncScope destroyed with children running"
+    );
+}
+
+void AsyncScope::spawn(Task<> task) {
+    task.promise().inherit_stop_token(stop_.get_token());
+    auto *child = detail::DetachedTask::create(std::move(task), &on_child_done, this);
+    // Counted once the node exists, a failed allocation leaves the count alone. And before it
+    // starts, it may finish before `run` returns.
+    count_.fetch_add(1, std::memory_order_relaxed);
+    child->run();
+}
+
+void AsyncScope::on_child_done(void *context, std::exception_ptr exception) noexcept {
+    auto *self = static_cast<AsyncScope *>(context);
+    if (exception && !self->failed_.exchange(true, std::memory_order_relaxed)) {
+        self->exception_ = std::move(exception);
+    }
+    if (self->count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        self->joiner_.resume();
+    }
+}
+
+void AsyncScope::finish_join() {
+    // Every child has arrived, the next join starts from scratch.
+    count_.store(1, std::memory_order_relaxed);
+    if (failed_.exchange(false, std::memory_order_relaxed)) {
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+}
+} // namespace myx_coroutine
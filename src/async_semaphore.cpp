@@ -0,0 +1,70 @@
+#include <myx_coroutine/async_semaphore.hpp>
+
+namespace myx_coroutine {
+
+bool AsyncSemaphore::acquire_or_enqueue(detail::AsyncWaiter *waiter) noexcept {
+    std::uintptr_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+        if (is_count(state) && state != encode(0)) {
+            if (state_.compare_exchange_weak(
+                    state, state - kOne, std::memory_order_acquire, std::memory_order_relaxed
+                )) {
+                return false;
+            }
+            continue;
+        }
+        waiter->next_ = is_count(state) ? nullptr : reinterpret_cast<detail::AsyncWaiter *>(state);
+        if (state_.compare_exchange_weak(
+                state, reinterpret_cast<std::uintptr_t>(waiter), std::memory_order_release,
+                std::memory_order_relaxed
+            )) {
+            return true;
+        }
+    }
+}
+
+void AsyncSemaphore::release_slow(std::size_t count) noexcept {
+    // Acquire pairs with the previous drainer's release, the private list is ours after it.
+    if (pending_.fetch_add(count, std::memory_order_acq_rel) != 0) {
+        return;
+    }
+    std::size_t batch = count;
+    while (true) {
+        for (std::size_t i = 0; i < batch; ++i) {
+            release_one();
+        }
+        std::size_t left = pending_.fetch_sub(batch, std::memory_order_acq_rel) - batch;
+        if (left == 0) {
+            return;
+        }
+        batch = left;
+    }
+}
+
+void AsyncSemaphore::release_one() noexcept {
+    if (waiters_ == nullptr) {
+        std::uintptr_t state = state_.load(std::memory_order_relaxed);
+        while (true) {
+            if (is_count(state) || state == 0) {
+                std::uintptr_t permits = is_count(state) ? state + kOne : encode(1);
+                if (state_.compare_exchange_weak(
+                        state, permits, std::memory_order_release, std::memory_order_relaxed
+                    )) {
+                    return;
+                }
+                continue;
+            }
+            // Taking the stack leaves the state even, new waiters keep stacking up on null.
+            std::uintptr_t stack = state_.exchange(0, std::memory_order_acquire);
+            waiters_ = detail::reverse_waiters(reinterpret_cast<detail::AsyncWaiter *>(stack));
+            if (waiters_ != nullptr) {
+                break;
+            }
+            state = 0;
+        }
+    }
+    detail::AsyncWaiter *next = waiters_;
+    waiters_ = next->next_;
+    next->handle_.resume();
+}
+} // namespace myx_coroutine
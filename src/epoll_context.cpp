@@ -0,0 +1,392 @@
+#if defined(__linux__)
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <myx_coroutine/detached_task.hpp>
+#include <myx_coroutine/epoll_context.hpp>
+#include <myx_coroutine/util.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace myx_coroutine {
+
+namespace {
+    constexpr std::uint64_t kCurrentPosition = static_cast<std::uint64_t>(-1);
+
+    [[noreturn]] void throw_errno(const char *what) {
+        throw std::system_error(errno, std::system_category(), what);
+    }
+
+    int result_of(long result) noexcept {
+        return result >= 0 ? static_cast<int>(result) : -errno;
+    }
+
+    int attempt_accept(detail::EpollWaiter *waiter) noexcept {
+        return result_of(::accept4(
+            waiter->fd_, static_cast<sockaddr *>(waiter->buffer_),
+            reinterpret_cast<socklen_t *>(waiter->extra_), waiter->flags_ | SOCK_NONBLOCK
+        ));
+    }
+
+    // The first attempt starts the connection, later ones check whether it is established.
+    int attempt_connect(detail::EpollWaiter *waiter) noexcept {
+        if (waiter->length_ != 0) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (::getsockopt(waiter->fd_, SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+                return -errno;
+            }
+            if (error != 0) {
+                return -error;
+            }
+        }
+        auto *addr = static_cast<const sockaddr *>(waiter->buffer_);
+        if (::connect(waiter->fd_, addr, static_cast<socklen_t>(waiter->extra_)) == 0) {
+            return 0;
+        }
+        switch (errno) {
+        case EISCONN:
+            return 0;
+        case EINPROGRESS:
+        case EALREADY:
+            waiter->length_ = 1;
+            return -EAGAIN;
+        default:
+            return -errno;
+        }
+    }
+
+    int attempt_recv(detail::EpollWaiter *waiter) noexcept {
+        return result_of(::recv(waiter->fd_, waiter->buffer_, waiter->length_, waiter->flags_));
+    }
+
+    int attempt_send(detail::EpollWaiter *waiter) noexcept {
+        return result_of(::send(waiter->fd_, waiter->buffer_, waiter->length_, waiter->flags_));
+    }
+
+    int attempt_read(detail::EpollWaiter *waiter) noexcept {
+        if (waiter->extra_ == kCurrentPosition) {
+            return result_of(::read(waiter->fd_, waiter->buffer_, waiter->length_));
+        }
+        return result_of(::pread(
+            waiter->fd_, waiter->buffer_, waiter->length_, static_cast<off_t>(waiter->extra_)
+        ));
+    }
+
+    int attempt_write(detail::EpollWaiter *waiter) noexcept {
+        if (waiter->extra_ == kCurrentPosition) {
+            return result_of(::write(waiter->fd_, waiter->buffer_, waiter->length_));
+        }
+        return result_of(::pwrite(
+            waiter->fd_, waiter->buffer_, waiter->length_, static_cast<off_t>(waiter->extra_)
+        ));
+    }
+
+    int attempt_close(detail::EpollWaiter *waiter) noexcept {
+        return result_of(::close(waiter->fd_));
+    }
+} // namespace
+
+EpollContext::EpollContext() {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw_errno("epoll_create1");
+    }
+    wakeup_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_fd_ < 0) {
+        int error = errno;
+        ::close(epoll_fd_);
+        errno = error;
+        throw_errno("eventfd");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = wakeup_fd_;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) != 0) {
+        int error = errno;
+        ::close(wakeup_fd_);
+        ::close(epoll_fd_);
+        errno = error;
+        throw_errno("epoll_ctl");
+    }
+}
+
+EpollContext::~EpollContext() {
+    ::close(wakeup_fd_);
+    ::close(epoll_fd_);
+}
+
+EpollContext::Operation
+EpollContext::accept(int fd, sockaddr *addr, socklen_t *addrlen, int flags) noexcept {
+    return Operation{*this,
+                     {.attempt_ = &attempt_accept,
+                      .fd_ = fd,
+                      .write_ = false,
+                      .buffer_ = addr,
+                      .extra_ = reinterpret_cast<std::uint64_t>(addrlen),
+                      .flags_ = flags}};
+}
+
+EpollContext::Operation
+EpollContext::connect(int fd, const sockaddr *addr, socklen_t addrlen) noexcept {
+    return Operation{*this,
+                     {.attempt_ = &attempt_connect,
+                      .fd_ = fd,
+                      .write_ = true,
+                      .buffer_ = const_cast<sockaddr *>(addr),
+                      .extra_ = addrlen}};
+}
+
+EpollContext::Operation
+EpollContext::recv(int fd, void *buffer, std::size_t length, int flags) noexcept {
+    return Operation{*this,
+                     {.attempt_ = &attempt_recv,
+                      .fd_ = fd,
+                      .write_ = false,
+                      .buffer_ = buffer,
+                      .length_ = length,
+                      .flags_ = flags}};
+}
+
+EpollContext::Operation
+EpollContext::send(int fd, const void *buffer, std::size_t length, int flags) noexcept {
+    return Operation{*this,
+                     {.attempt_ = &attempt_send,
+                      .fd_ = fd,
+                      .write_ = true,
+                      .buffer_ = const_cast<void *>(buffer),
+                      .length_ = length,
+                      .flags_ = flags}};
+}
+
+EpollContext::Operation
+EpollContext::read(int fd, void *buffer, std::size_t length, std::uint64_t offset) noexcept {
+    return Operation{*this,
+                     {.attempt_ = &attempt_read,
+                      .fd_ = fd,
+                      .write_ = false,
+                      .buffer_ = buffer,
+                      .length_ = length,
+                      .extra_ = offset}};
+}
+
+EpollContext::Operation EpollContext::write(
+    int fd, const void *buffer, std::size_t length, std::uint64_t offset
+) noexcept {
+    return Operation{*this,
+                     {.attempt_ = &attempt_write,
+                      .fd_ = fd,
+                      .write_ = true,
+                      .buffer_ = const_cast<void *>(buffer),
+                      .length_ = length,
+                      .extra_ = offset}};
+}
+
+EpollContext::Operation EpollContext::close(int fd) noexcept {
+    return Operation{*this, {.attempt_ = &attempt_close, .fd_ = fd, .write_ = false}};
+}
+
+void EpollContext::spawn(Task<> task) {
+    ++spawned_;
+    detail::DetachedTask::start(std::move(task), &on_spawned_done, this);
+}
+
+void EpollContext::on_spawned_done(void *context, std::exception_ptr exception) noexcept {
+    auto *self = static_cast<EpollContext *>(context);
+    --self->spawned_;
+    if (exception && !self->spawned_exception_) {
+        self->spawned_exception_ = std::move(exception);
+    }
+}
+
+EpollContext::FdState &EpollContext::state_of(int fd) {
+    auto index = static_cast<std::size_t>(fd);
+    if (index >= fds_.size()) {
+        fds_.resize(std::max(index + 1, fds_.size() * 2));
+    }
+    FdState &state = fds_[index];
+    if (!state.registered_) {
+        state.registered_ = true;
+        int flags = ::fcntl(fd, F_GETFL);
+        if (flags >= 0 && (flags & O_NONBLOCK) == 0) {
+            ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = fd;
+        // EPERM for regular files, which never block. Any other error is reported by the
+        // syscall itself.
+        state.pollable_ = ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+    return state;
+}
+
+void EpollContext::forget(int fd) noexcept {
+    if (fd < 0 || static_cast<std::size_t>(fd) >= fds_.size()) {
+        return;
+    }
+    FdState &state = fds_[fd];
+    MESSAGE_ASSERT(
+        state.reader_ == nullptr && state.writer_ == nullptr,
+        "forgetting a descriptor with pending operations"
+    );
+    if (state.registered_ && state.pollable_) {
+        // Fails harmlessly if the descriptor is closed already, epoll dropped it then.
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    state = FdState{};
+}
+
+bool EpollContext::try_now(detail::EpollWaiter &waiter) {
+    if (waiter.fd_ < 0) {
+        waiter.result_ = -EBADF;
+        return true;
+    }
+    if (waiter.attempt_ == &attempt_close) {
+        // The descriptor number may be reused right away, its state must not leak into that.
+        if (static_cast<std::size_t>(waiter.fd_) < fds_.size()) {
+            FdState &state = fds_[waiter.fd_];
+            MESSAGE_ASSERT(
+                state.reader_ == nullptr && state.writer_ == nullptr,
+                "closing a descriptor with pending operations"
+            );
+            state = FdState{};
+        }
+        waiter.result_ = waiter.attempt_(&waiter);
+        return true;
+    }
+
+    FdState &state = state_of(waiter.fd_);
+    bool &ready = waiter.write_ ? state.writable_ : state.readable_;
+    if (!ready) {
+        return false;
+    }
+    int result = waiter.attempt_(&waiter);
+    if (result == -EAGAIN && state.pollable_) {
+        ready = false;
+        return false;
+    }
+    waiter.result_ = result;
+    return true;
+}
+
+void EpollContext::park(detail::EpollWaiter &waiter) {
+    FdState &state = fds_[waiter.fd_];
+    detail::EpollWaiter *&slot = waiter.write_ ? state.writer_ : state.reader_;
+    MESSAGE_ASSERT(slot == nullptr, "one reader and one writer per descriptor at a time");
+    slot = &waiter;
+    ++in_flight_;
+}
+
+bool EpollContext::drive(int fd, bool write) {
+    // Looked up again every time, a resumed coroutine may have grown the table.
+    FdState &state = fds_[fd];
+    detail::EpollWaiter *&slot = write ? state.writer_ : state.reader_;
+    detail::EpollWaiter *waiter = slot;
+    if (waiter == nullptr) {
+        return false;
+    }
+    int result = waiter->attempt_(waiter);
+    if (result == -EAGAIN) {
+        (write ? state.writable_ : state.readable_) = false;
+        return false;
+    }
+    slot = nullptr;
+    waiter->result_ = result;
+    if (waiter->operation_->complete()) {
+        --in_flight_;
+        waiter->handle_.resume();
+    }
+    return true;
+}
+
+void EpollContext::request_cancel(void *owner, detail::CancellableOperation *operation) noexcept {
+    auto *self = static_cast<EpollContext *>(owner);
+    if (self->cancels_.push(operation)) {
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(self->wakeup_fd_, &one, sizeof(one));
+    }
+}
+
+std::size_t EpollContext::cancel_requested() {
+    std::size_t resumed = 0;
+    detail::CancellableOperation *next = cancels_.take_all();
+    while (next != nullptr) {
+        auto *operation = static_cast<Operation *>(next);
+        next = next->cancel_next_;
+        detail::EpollWaiter &waiter = operation->waiter_;
+        if (operation->begin_cancel()) {
+            FdState &state = fds_[waiter.fd_];
+            (waiter.write_ ? state.writer_ : state.reader_) = nullptr;
+        }
+        // Otherwise it completed first and was left for us to resume.
+        --in_flight_;
+        ++resumed;
+        waiter.handle_.resume();
+    }
+    return resumed;
+}
+
+std::size_t EpollContext::run_once(bool wait) {
+    std::size_t completed = cancel_requested();
+    // Resuming cancelled operations counts as progress, nothing to block for then.
+    wait = wait && completed == 0;
+    std::array<epoll_event, 128> events;
+    int count = ::epoll_wait(epoll_fd_, events.data(), events.size(), wait ? -1 : 0);
+    if (count < 0) {
+        if (errno == EINTR) {
+            return completed;
+        }
+        throw_errno("epoll_wait");
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+        std::uint32_t mask = events[i].events;
+        if (fd == wakeup_fd_) {
+            std::uint64_t value;
+            [[maybe_unused]] auto bytes = ::read(wakeup_fd_, &value, sizeof(value));
+            continue;
+        }
+        if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+            fds_[fd].readable_ = true;
+            completed += drive(fd, false);
+        }
+        if (mask & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+            fds_[fd].writable_ = true;
+            completed += drive(fd, true);
+        }
+    }
+    return completed;
+}
+
+void EpollContext::run() {
+    while (true) {
+        if (spawned_exception_) {
+            stop_requested_.store(false, std::memory_order_relaxed);
+            std::rethrow_exception(std::exchange(spawned_exception_, nullptr));
+        }
+        if (stop_requested_.load(std::memory_order_acquire) || (in_flight_ == 0 && spawned_ == 0)) {
+            break;
+        }
+        run_once();
+    }
+    // Ready to run again.
+    stop_requested_.store(false, std::memory_order_relaxed);
+}
+
+void EpollContext::stop() noexcept {
+    stop_requested_.store(true, std::memory_order_release);
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto written = ::write(wakeup_fd_, &one, sizeof(one));
+}
+} // namespace myx_coroutine
+
+#endif
@@ -0,0 +1,222 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <myx_coroutine/frame_pool.hpp>
+#include <new>
+
+namespace myx_coroutine {
+
+namespace {
+    constexpr std::size_t kGranularity = 64;
+    constexpr std::size_t kClassCount = 32; // blocks up to 2 KiB are pooled
+    constexpr std::size_t kMaxCachedPerClass = 256;
+    constexpr std::size_t kUnpooled = kClassCount;
+
+    struct ThreadCache;
+
+    // Sits in front of every frame, keeps the frame aligned to the default new alignment.
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) BlockHeader {
+        ThreadCache *owner_;
+        std::size_t size_class_;
+    };
+
+    // Free blocks are linked through the first word of their payload.
+    BlockHeader *&next_of(BlockHeader *block) noexcept {
+        return *reinterpret_cast<BlockHeader **>(block + 1);
+    }
+
+    constexpr std::size_t class_size(std::size_t size_class) {
+        return (size_class + 1) * kGranularity;
+    }
+
+    struct alignas(64) ThreadCache {
+        void push_local(BlockHeader *block) noexcept {
+            auto c = block->size_class_;
+            if (count_[c] >= kMaxCachedPerClass) {
+                ::operator delete(block);
+                return;
+            }
+            next_of(block) = free_[c];
+            free_[c] = block;
+            ++count_[c];
+        }
+
+        BlockHeader *pop_local(std::size_t c) noexcept {
+            BlockHeader *block = free_[c];
+            if (block != nullptr) {
+                free_[c] = next_of(block);
+                --count_[c];
+            }
+            return block;
+        }
+
+        void push_remote(BlockHeader *block) noexcept {
+            BlockHeader *head = remote_.load(std::memory_order_relaxed);
+            do {
+                next_of(block) = head;
+            } while (!remote_.compare_exchange_weak(
+                head, block, std::memory_order_release, std::memory_order_relaxed
+            ));
+        }
+
+        void drain_remote() noexcept {
+            BlockHeader *block = remote_.exchange(nullptr, std::memory_order_acquire);
+            while (block != nullptr) {
+                BlockHeader *next = next_of(block);
+                push_local(block);
+                block = next;
+            }
+        }
+
+        void release_local() noexcept {
+            for (std::size_t c = 0; c < kClassCount; ++c) {
+                while (BlockHeader *block = pop_local(c)) {
+                    ::operator delete(block);
+                }
+            }
+        }
+
+        static void bump(std::atomic<std::uint64_t> &counter) noexcept {
+            // Single writer, no need for a locked add.
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        std::array<BlockHeader *, kClassCount> free_{};
+        std::array<std::size_t, kClassCount> count_{};
+        std::atomic<std::uint64_t> hits_{0};
+        std::atomic<std::uint64_t> misses_{0};
+
+        alignas(64) std::atomic<BlockHeader *> remote_{nullptr};
+        std::atomic<std::uint64_t> remote_frees_{0};
+
+        // Registry bookkeeping, guarded by Registry::mtx_.
+        ThreadCache *next_in_registry_ = nullptr;
+        bool in_use_ = false;
+    };
+
+    // Caches are never freed: frames may outlive the thread that allocated them and still
+    // point at their owner. A cache left behind by an exited thread is adopted by the next new
+    // thread, which also drains whatever was returned to it in the meantime.
+    struct Registry {
+        ThreadCache *acquire() {
+            std::lock_guard lock(mtx_);
+            for (ThreadCache *cache = head_; cache != nullptr; cache = cache->next_in_registry_) {
+                if (!cache->in_use_) {
+                    cache->in_use_ = true;
+                    return cache;
+                }
+            }
+            auto *cache = new ThreadCache();
+            cache->in_use_ = true;
+            cache->next_in_registry_ = head_;
+            head_ = cache;
+            return cache;
+        }
+
+        void release(ThreadCache *cache) {
+            cache->release_local();
+            std::lock_guard lock(mtx_);
+            cache->in_use_ = false;
+        }
+
+        FramePoolStats stats() {
+            FramePoolStats stats;
+            std::lock_guard lock(mtx_);
+            for (ThreadCache *cache = head_; cache != nullptr; cache = cache->next_in_registry_) {
+                stats.hits += cache->hits_.load(std::memory_order_relaxed);
+                stats.misses += cache->misses_.load(std::memory_order_relaxed);
+                stats.remote_frees += cache->remote_frees_.load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+        std::mutex mtx_;
+        ThreadCache *head_ = nullptr;
+    };
+
+    Registry &registry() {
+        // Leaked on purpose, thread caches may be released after static destruction.
+        static auto *registry = new Registry();
+        return *registry;
+    }
+
+    // Set once the thread's cache went back to the registry, frames touched by later
+    // thread_local destructors bypass the pool.
+    thread_local bool t_cache_released = false;
+
+    struct ThreadCacheHolder {
+        ThreadCacheHolder() : cache_(registry().acquire()) {}
+
+        ~ThreadCacheHolder() {
+            t_cache_released = true;
+            registry().release(cache_);
+        }
+
+        ThreadCache *cache_;
+    };
+
+    ThreadCache *local_cache() {
+        if (t_cache_released) [[unlikely]] {
+            return nullptr;
+        }
+        static thread_local ThreadCacheHolder holder;
+        return holder.cache_;
+    }
+} // namespace
+
+FramePoolStats frame_pool_stats() noexcept {
+    return registry().stats();
+}
+
+namespace detail {
+    void *frame_pool_allocate(std::size_t size) {
+        std::size_t total = size + sizeof(BlockHeader);
+        ThreadCache *cache = local_cache();
+        std::size_t c = (total - 1) / kGranularity;
+        if (c >= kClassCount || cache == nullptr) {
+            if (cache != nullptr) {
+                ThreadCache::bump(cache->misses_);
+            }
+            auto *block = static_cast<BlockHeader *>(::operator new(total));
+            block->owner_ = nullptr;
+            block->size_class_ = kUnpooled;
+            return block + 1;
+        }
+
+        BlockHeader *block = cache->pop_local(c);
+        if (block == nullptr && cache->remote_.load(std::memory_order_relaxed) != nullptr) {
+            cache->drain_remote();
+            block = cache->pop_local(c);
+        }
+        if (block != nullptr) {
+            ThreadCache::bump(cache->hits_);
+        } else {
+            ThreadCache::bump(cache->misses_);
+            block = static_cast<BlockHeader *>(::operator new(class_size(c)));
+            block->owner_ = cache;
+            block->size_class_ = c;
+        }
+        return block + 1;
+    }
+
+    void frame_pool_deallocate(void *ptr) noexcept {
+        auto *block = static_cast<BlockHeader *>(ptr) - 1;
+        ThreadCache *owner = block->owner_;
+        if (owner == nullptr) {
+            ::operator delete(block);
+            return;
+        }
+        ThreadCache *local = local_cache();
+        if (owner == local) {
+            owner->push_local(block);
+        } else {
+            owner->push_remote(block);
+            if (local != nullptr) {
+                ThreadCache::bump(local->remote_frees_);
+            }
+        }
+    }
+} // namespace detail
+} // namespace myx_coroutine
@@ -0,0 +1,389 @@
+#if defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <myx_coroutine/detached_task.hpp>
+#include <myx_coroutine/io_uring_context.hpp>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace myx_coroutine {
+
+namespace {
+    // `user_data` of the eventfd read that wakes the loop up for `stop` and cancel requests.
+    constexpr std::uint64_t kWakeup = 0;
+    // `user_data` of IORING_OP_ASYNC_CANCEL entries, whose own completions are ignored.
+    constexpr std::uint64_t kCancel = 1;
+
+    [[noreturn]] void throw_errno(const char *what) {
+        throw std::system_error(errno, std::system_category(), what);
+    }
+
+    template<typename T>
+    T *at(void *base, std::uint32_t offset) noexcept {
+        return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+    }
+
+    std::uint32_t load_acquire(const std::uint32_t *p) noexcept {
+        return std::atomic_ref(*const_cast<std::uint32_t *>(p)).load(std::memory_order_acquire);
+    }
+
+    void store_release(std::uint32_t *p, std::uint32_t value) noexcept {
+        std::atomic_ref(*p).store(value, std::memory_order_release);
+    }
+} // namespace
+
+// The three shared mappings of the ring, set up with the raw syscalls so no library is needed.
+// The submission side is only written by the loop thread: `sqe_tail_` counts the entries
+// handed out, and they are published to the kernel in one go by `submit`.
+struct IoUringContext::Ring {
+    static constexpr int kProt = PROT_READ | PROT_WRITE;
+    static constexpr int kFlags = MAP_SHARED | MAP_POPULATE;
+
+    explicit Ring(unsigned entries) {
+        io_uring_params params{};
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) {
+            throw_errno("io_uring_setup");
+        }
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(std::uint32_t);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sq_ptr_ = ::mmap(nullptr, sq_size_, kProt, kFlags, fd_, IORING_OFF_SQ_RING);
+        cq_ptr_ = single_mmap
+                      ? sq_ptr_
+                      : ::mmap(nullptr, cq_size_, kProt, kFlags, fd_, IORING_OFF_CQ_RING);
+        void *sqes = ::mmap(nullptr, sqes_size_, kProt, kFlags, fd_, IORING_OFF_SQES);
+        sqes_ = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe *>(sqes);
+        if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes_ == nullptr) {
+            int error = errno;
+            release();
+            errno = error;
+            throw_errno("io_uring mmap");
+        }
+
+        sq_head_ = at<std::uint32_t>(sq_ptr_, params.sq_off.head);
+        sq_tail_ = at<std::uint32_t>(sq_ptr_, params.sq_off.tail);
+        sq_mask_ = *at<std::uint32_t>(sq_ptr_, params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        cq_head_ = at<std::uint32_t>(cq_ptr_, params.cq_off.head);
+        cq_tail_ = at<std::uint32_t>(cq_ptr_, params.cq_off.tail);
+        cq_mask_ = *at<std::uint32_t>(cq_ptr_, params.cq_off.ring_mask);
+        cqes_ = at<io_uring_cqe>(cq_ptr_, params.cq_off.cqes);
+
+        // Entry i always sits in slot i, the indirection array is set up once.
+        auto *array = at<std::uint32_t>(sq_ptr_, params.sq_off.array);
+        for (std::uint32_t i = 0; i < sq_entries_; ++i) {
+            array[i] = i;
+        }
+        sqe_tail_ = *sq_tail_;
+    }
+
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    ~Ring() { release(); }
+
+    void release() noexcept {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+            ::munmap(cq_ptr_, cq_size_);
+        }
+        if (sq_ptr_ != MAP_FAILED) {
+            ::munmap(sq_ptr_, sq_size_);
+        }
+        ::close(fd_);
+    }
+
+    // nullptr if every entry is handed out and not yet consumed by the kernel.
+    io_uring_sqe *get_sqe() noexcept {
+        if (sqe_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+            return nullptr;
+        }
+        io_uring_sqe *sqe = &sqes_[sqe_tail_ & sq_mask_];
+        ++sqe_tail_;
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    // Entries the kernel has not consumed yet. Those published by an earlier `io_uring_enter`
+    // that submitted only part of the batch are counted again.
+    std::uint32_t unsubmitted() const noexcept { return sqe_tail_ - load_acquire(sq_head_); }
+
+    bool cq_ready() const noexcept { return load_acquire(cq_tail_) != *cq_head_; }
+
+    int fd_;
+    std::size_t sq_size_;
+    std::size_t cq_size_;
+    std::size_t sqes_size_;
+    void *sq_ptr_ = MAP_FAILED;
+    void *cq_ptr_ = MAP_FAILED;
+    io_uring_sqe *sqes_ = nullptr;
+    std::uint32_t *sq_head_;
+    std::uint32_t *sq_tail_;
+    std::uint32_t sq_mask_;
+    std::uint32_t sq_entries_;
+    std::uint32_t sqe_tail_;
+    std::uint32_t *cq_head_;
+    std::uint32_t *cq_tail_;
+    std::uint32_t cq_mask_;
+    io_uring_cqe *cqes_;
+};
+
+IoUringContext::IoUringContext(unsigned entries) : ring_(new Ring(entries)) {
+    wakeup_fd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        delete ring_;
+        throw_errno("eventfd");
+    }
+    arm_wakeup();
+}
+
+IoUringContext::~IoUringContext() {
+    // Closing the ring cancels whatever is still in flight.
+    delete ring_;
+    ::close(wakeup_fd_);
+}
+
+IoUringContext::Operation
+IoUringContext::accept(int fd, sockaddr *addr, socklen_t *addrlen, int flags) noexcept {
+    return {*this,
+            {.opcode_ = IORING_OP_ACCEPT,
+             .fd_ = fd,
+             .addr_ = reinterpret_cast<std::uint64_t>(addr),
+             .off_ = reinterpret_cast<std::uint64_t>(addrlen),
+             .op_flags_ = static_cast<std::uint32_t>(flags)}};
+}
+
+IoUringContext::Operation
+IoUringContext::connect(int fd, const sockaddr *addr, socklen_t addrlen) noexcept {
+    return {*this,
+            {.opcode_ = IORING_OP_CONNECT,
+             .fd_ = fd,
+             .addr_ = reinterpret_cast<std::uint64_t>(addr),
+             .off_ = addrlen}};
+}
+
+IoUringContext::Operation
+IoUringContext::recv(int fd, void *buffer, std::size_t length, int flags) noexcept {
+    return {*this,
+            {.opcode_ = IORING_OP_RECV,
+             .fd_ = fd,
+             .addr_ = reinterpret_cast<std::uint64_t>(buffer),
+             .len_ = static_cast<std::uint32_t>(length),
+             .op_flags_ = static_cast<std::uint32_t>(flags)}};
+}
+
+IoUringContext::Operation
+IoUringContext::send(int fd, const void *buffer, std::size_t length, int flags) noexcept {
+    return {*this,
+            {.opcode_ = IORING_OP_SEND,
+             .fd_ = fd,
+             .addr_ = reinterpret_cast<std::uint64_t>(buffer),
+             .len_ = static_cast<std::uint32_t>(length),
+             .op_flags_ = static_cast<std::uint32_t>(flags)}};
+}
+
+IoUringContext::Operation
+IoUringContext::read(int fd, void *buffer, std::size_t length, std::uint64_t offset) noexcept {
+    return {*this,
+            {.opcode_ = IORING_OP_READ,
+             .fd_ = fd,
+             .addr_ = reinterpret_cast<std::uint64_t>(buffer),
+             .len_ = static_cast<std::uint32_t>(length),
+             .off_ = offset}};
+}
+
+IoUringContext::Operation IoUringContext::write(
+    int fd, const void *buffer, std::size_t length, std::uint64_t offset
+) noexcept {
+    return {*this,
+            {.opcode_ = IORING_OP_WRITE,
+             .fd_ = fd,
+             .addr_ = reinterpret_cast<std::uint64_t>(buffer),
+             .len_ = static_cast<std::uint32_t>(length),
+             .off_ = offset}};
+}
+
+IoUringContext::Operation IoUringContext::close(int fd) noexcept {
+    return {*this, {.opcode_ = IORING_OP_CLOSE, .fd_ = fd}};
+}
+
+void IoUringContext::spawn(Task<> task) {
+    ++spawned_;
+    detail::DetachedTask::start(std::move(task), &on_spawned_done, this);
+}
+
+void IoUringContext::on_spawned_done(void *context, std::exception_ptr exception) noexcept {
+    auto *self = static_cast<IoUringContext *>(context);
+    --self->spawned_;
+    if (exception && !self->spawned_exception_) {
+        self->spawned_exception_ = std::move(exception);
+    }
+}
+
+void IoUringContext::prepare(const detail::IoRequest &request, detail::IoCompletion *completion) {
+    io_uring_sqe *sqe = ring_->get_sqe();
+    if (sqe == nullptr) {
+        // Every entry is queued already, hand them over early to make room.
+        submit(false);
+        sqe = ring_->get_sqe();
+        if (sqe == nullptr) {
+            throw std::system_error(EBUSY, std::system_category(), "io_uring submission queue");
+        }
+    }
+    sqe->opcode = request.opcode_;
+    sqe->fd = request.fd_;
+    sqe->addr = request.addr_;
+    sqe->len = request.len_;
+    sqe->off = request.off_;
+    sqe->rw_flags = static_cast<__kernel_rwf_t>(request.op_flags_);
+    sqe->user_data = reinterpret_cast<std::uint64_t>(completion);
+    ++in_flight_;
+}
+
+void IoUringContext::arm_wakeup() {
+    io_uring_sqe *sqe = ring_->get_sqe();
+    if (sqe == nullptr) {
+        submit(false);
+        sqe = ring_->get_sqe();
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeup_fd_;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&wakeup_buffer_);
+    sqe->len = sizeof(wakeup_buffer_);
+    sqe->user_data = kWakeup;
+    wakeup_armed_ = true;
+}
+
+void IoUringContext::request_cancel(void *owner, detail::CancellableOperation *operation) noexcept {
+    auto *self = static_cast<IoUringContext *>(owner);
+    if (self->cancels_.push(operation)) {
+        std::uint64_t one = 1;
+        [[maybe_unused]] auto written = ::write(self->wakeup_fd_, &one, sizeof(one));
+    }
+}
+
+std::size_t IoUringContext::cancel_requested() {
+    std::size_t resumed = 0;
+    detail::CancellableOperation *operation = cancels_.take_all();
+    while (operation != nullptr) {
+        auto *completion = static_cast<detail::IoCompletion *>(operation);
+        operation = operation->cancel_next_;
+        if (!completion->begin_cancel()) {
+            // Its completion came first and was left for us.
+            --in_flight_;
+            ++resumed;
+            completion->handle_.resume();
+            continue;
+        }
+        io_uring_sqe *sqe = ring_->get_sqe();
+        if (sqe == nullptr) {
+            submit(false);
+            sqe = ring_->get_sqe();
+            if (sqe == nullptr) {
+                throw std::system_error(
+                    EBUSY, std::system_category(), "io_uring submission queue"
+                );
+            }
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<std::uint64_t>(completion);
+        sqe->user_data = kCancel;
+    }
+    return resumed;
+}
+
+void IoUringContext::submit(bool wait) {
+    std::uint32_t to_submit = ring_->unsubmitted();
+    // Completions that are already there are handled before anything blocks.
+    unsigned min_complete = wait && !ring_->cq_ready() ? 1 : 0;
+    if (to_submit == 0 && min_complete == 0) {
+        return;
+    }
+    store_release(ring_->sq_tail_, ring_->sqe_tail_);
+    unsigned flags = min_complete != 0 ? IORING_ENTER_GETEVENTS : 0;
+    // A short or failed submit leaves the rest behind `sq_head_`, the next call passes them
+    // again. Interrupted, or the completion queue has to be drained first: the next iteration
+    // submits what is left.
+    if (syscall(__NR_io_uring_enter, ring_->fd_, to_submit, min_complete, flags, nullptr, 0) < 0
+        && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+        throw_errno("io_uring_enter");
+    }
+}
+
+std::size_t IoUringContext::run_once(bool wait) {
+    std::size_t handled = cancel_requested();
+    // Resuming cancelled operations counts as progress, nothing to block for then.
+    submit(wait && handled == 0);
+
+    std::uint32_t head = *ring_->cq_head_;
+    while (head != load_acquire(ring_->cq_tail_)) {
+        const io_uring_cqe &cqe = ring_->cqes_[head & ring_->cq_mask_];
+        std::uint64_t user_data = cqe.user_data;
+        int result = cqe.res;
+        // Released before resuming, the coroutine may queue new entries right away.
+        store_release(ring_->cq_head_, ++head);
+        ++handled;
+
+        if (user_data == kWakeup) {
+            wakeup_armed_ = false;
+            continue;
+        }
+        if (user_data == kCancel) {
+            continue;
+        }
+        auto *completion = reinterpret_cast<detail::IoCompletion *>(user_data);
+        completion->result_ = result;
+        if (completion->complete()) {
+            --in_flight_;
+            completion->handle_.resume();
+        }
+    }
+
+    if (!wakeup_armed_) {
+        arm_wakeup();
+    }
+    return handled;
+}
+
+void IoUringContext::run() {
+    while (true) {
+        if (spawned_exception_) {
+            stop_requested_.store(false, std::memory_order_relaxed);
+            std::rethrow_exception(std::exchange(spawned_exception_, nullptr));
+        }
+        if (stop_requested_.load(std::memory_order_acquire) || (in_flight_ == 0 && spawned_ == 0)) {
+            break;
+        }
+        run_once();
+    }
+    // Ready to run again.
+    stop_requested_.store(false, std::memory_order_relaxed);
+}
+
+void IoUringContext::stop() noexcept {
+    stop_requested_.store(true, std::memory_order_release);
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto written = ::write(wakeup_fd_, &one, sizeof(one));
+}
+} // namespace myx_coroutine
+
+#endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <myx_coroutine/chunked_generator.hpp>
 #include <myx_coroutine/generator.hpp>
 #include <myx_coroutine/task.hpp>
 
@@ -8,4 +10,19 @@ Generator<int> count_to(int n) {
         co_yield i;
     }
 }
+
+ChunkedGenerator<int> count_to_chunked(int n) {
+    std::span<int> buffer = co_await chunk_buffer;
+    for (int i = 0; i < n;) {
+        auto count = static_cast<int>(std::min<std::size_t>(buffer.size(), n - i));
+        // Nothing in here lives across a suspension point, so the fill loop stays in
+        // registers.
+        int *out = buffer.data();
+        for (int k = 0; k < count; ++k) {
+            out[k] = i + k;
+        }
+        i += count;
+        buffer = co_yield static_cast<std::size_t>(count);
+    }
+}
 } // namespace myx_coroutine
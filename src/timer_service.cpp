@@ -0,0 +1,122 @@
+#include <chrono>
+#include <mutex>
+#include <myx_coroutine/timer_service.hpp>
+
+namespace myx_coroutine {
+
+namespace {
+    // The service whose thread is the current one, if any.
+    thread_local TimerService *tls_timer_thread_of = nullptr;
+} // namespace
+
+TimerService::TimerService(Clock::duration resolution)
+    : epoch_(Clock::now()), resolution_(resolution) {
+    thread_ = std::thread([this] { run(); });
+}
+
+TimerService::~TimerService() {
+    {
+        std::lock_guard lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+TimerService &TimerService::get_default() {
+    static TimerService service;
+    return service;
+}
+
+std::uint64_t TimerService::to_tick(Clock::time_point time) const noexcept {
+    if (time <= epoch_) {
+        return 0;
+    }
+    auto elapsed = time - epoch_;
+    return static_cast<std::uint64_t>((elapsed + resolution_ - Clock::duration(1)) / resolution_);
+}
+
+TimerService::Clock::time_point TimerService::to_time(std::uint64_t tick) const noexcept {
+    return epoch_ + static_cast<Clock::rep>(tick) * resolution_;
+}
+
+void TimerService::schedule(detail::TimerNode *node, Clock::time_point deadline) noexcept {
+    node->deadline_ = to_tick(deadline);
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    if (tls_timer_thread_of == this) {
+        // Rescheduled from a callback, the wheel is ours.
+        wheel_.insert(node);
+        return;
+    }
+    detail::TimerNode *head = incoming_.load(std::memory_order_relaxed);
+    do {
+        node->next_ = head;
+    } while (!incoming_.compare_exchange_weak(
+        head, node, std::memory_order_release, std::memory_order_relaxed
+    ));
+    if (head == nullptr) {
+        // Under the lock, or the wakeup could fall between the thread's check and its wait.
+        std::lock_guard lock(mtx_);
+        cv_.notify_one();
+    }
+}
+
+void TimerService::drain_incoming() noexcept {
+    detail::TimerNode *node = incoming_.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr) {
+        detail::TimerNode *next = node->next_;
+        wheel_.insert(node);
+        node = next;
+    }
+}
+
+void TimerService::request_cancel(void *owner, detail::CancellableOperation *operation) noexcept {
+    auto *self = static_cast<TimerService *>(owner);
+    if (self->cancels_.push(operation)) {
+        std::lock_guard lock(self->mtx_);
+        self->cv_.notify_one();
+    }
+}
+
+void TimerService::cancel(detail::CancellableOperation *operations) noexcept {
+    while (operations != nullptr) {
+        auto *awaiter = static_cast<SleepAwaiter *>(operations);
+        operations = operations->cancel_next_;
+        if (awaiter->begin_cancel()) {
+            wheel_.remove(awaiter);
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        // Otherwise it fired first and was left for us to resume.
+        awaiter->handle_.resume();
+    }
+}
+
+void TimerService::run() {
+    tls_timer_thread_of = this;
+    auto has_work = [this] {
+        return stop_ || incoming_.load(std::memory_order_acquire) != nullptr
+               || !cancels_.empty();
+    };
+
+    std::unique_lock lock(mtx_);
+    while (!stop_) {
+        lock.unlock();
+        // Requests first: a sleep whose request is seen has its node seen by the drain too.
+        detail::CancellableOperation *cancels = cancels_.take_all();
+        drain_incoming();
+        cancel(cancels);
+        // Whole ticks elapsed, rounded down, so nothing fires before its deadline.
+        auto now = static_cast<std::uint64_t>((Clock::now() - epoch_) / resolution_);
+        std::size_t fired = wheel_.advance(now);
+        pending_.fetch_sub(fired, std::memory_order_relaxed);
+        lock.lock();
+
+        std::uint64_t next = wheel_.next_event();
+        if (next == detail::TimerWheel::kNever) {
+            cv_.wait(lock, has_work);
+        } else {
+            cv_.wait_until(lock, to_time(next), has_work);
+        }
+    }
+}
+} // namespace myx_coroutine
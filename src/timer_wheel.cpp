@@ -0,0 +1,136 @@
+#include <bit>
+#include <cstdint>
+#include <myx_coroutine/timer_wheel.hpp>
+
+namespace myx_coroutine {
+namespace detail {
+
+    void TimerWheel::insert(TimerNode *node) noexcept {
+        if (node->deadline_ < current_) {
+            node->deadline_ = current_;
+        }
+        ++size_;
+        link(node);
+    }
+
+    void TimerWheel::link(TimerNode *node) noexcept {
+        std::uint64_t diff = node->deadline_ ^ current_;
+        int level = diff == 0 ? 0 : (std::bit_width(diff) - 1) / kSlotBits;
+        int slot = digit(node->deadline_, level);
+        node->level_ = static_cast<std::uint8_t>(level);
+        node->slot_ = static_cast<std::uint8_t>(slot);
+
+        TimerNode *&head = levels_[level].slots_[slot];
+        node->prev_ = nullptr;
+        node->next_ = head;
+        if (head != nullptr) {
+            head->prev_ = node;
+        }
+        head = node;
+        levels_[level].occupied_[slot / 64] |= std::uint64_t{1} << (slot % 64);
+    }
+
+    void TimerWheel::remove(TimerNode *node) noexcept {
+        Level &level = levels_[node->level_];
+        if (node->prev_ != nullptr) {
+            node->prev_->next_ = node->next_;
+        } else {
+            level.slots_[node->slot_] = node->next_;
+            if (node->next_ == nullptr) {
+                level.occupied_[node->slot_ / 64] &= ~(std::uint64_t{1} << (node->slot_ % 64));
+            }
+        }
+        if (node->next_ != nullptr) {
+            node->next_->prev_ = node->prev_;
+        }
+        node->prev_ = node->next_ = nullptr;
+        --size_;
+    }
+
+    TimerNode *TimerWheel::take_slot(int level, int slot) noexcept {
+        Level &l = levels_[level];
+        TimerNode *head = l.slots_[slot];
+        l.slots_[slot] = nullptr;
+        l.occupied_[slot / 64] &= ~(std::uint64_t{1} << (slot % 64));
+        return head;
+    }
+
+    int TimerWheel::find_slot(int level, int from) const noexcept {
+        const Level &l = levels_[level];
+        for (int word = from / 64; word < kSlots / 64; ++word) {
+            std::uint64_t bits = l.occupied_[word];
+            if (word == from / 64) {
+                bits &= ~std::uint64_t{0} << (from % 64);
+            }
+            if (bits != 0) {
+                return word * 64 + std::countr_zero(bits);
+            }
+        }
+        return -1;
+    }
+
+    std::uint64_t TimerWheel::next_event() const noexcept {
+        if (size_ == 0) {
+            return kNever;
+        }
+        // Occupied slots are never behind the current digit of their level, and only level 0
+        // and slots the current tick has just entered, still to be cascaded, can be on it.
+        // The lowest level with an occupied slot therefore holds the next event.
+        for (int level = 0; level < kLevels; ++level) {
+            std::uint64_t low_mask = (std::uint64_t{1} << (level * kSlotBits)) - 1;
+            bool at_slot_start = (current_ & low_mask) == 0;
+            int from = digit(current_, level) + (at_slot_start ? 0 : 1);
+            if (from >= kSlots) {
+                continue;
+            }
+            int slot = find_slot(level, from);
+            if (slot < 0) {
+                continue;
+            }
+            int shift = (level + 1) * kSlotBits;
+            std::uint64_t high = shift >= 64 ? 0 : (current_ >> shift) << shift;
+            return high | (static_cast<std::uint64_t>(slot) << (level * kSlotBits));
+        }
+        return kNever;
+    }
+
+    std::size_t TimerWheel::advance(std::uint64_t now) {
+        std::size_t fired = 0;
+        while (current_ <= now) {
+            std::uint64_t tick = next_event();
+            if (tick > now) {
+                // Nothing is due in between, not even a cascade.
+                current_ = now + 1;
+                break;
+            }
+            current_ = tick;
+
+            // Cascade every level whose slot starts at this tick, highest first, so timers
+            // trickle down to the level matching their remaining distance.
+            for (int level = kLevels - 1; level > 0; --level) {
+                std::uint64_t low_mask = (std::uint64_t{1} << (level * kSlotBits)) - 1;
+                if ((tick & low_mask) != 0) {
+                    continue;
+                }
+                TimerNode *node = take_slot(level, digit(tick, level));
+                while (node != nullptr) {
+                    TimerNode *next = node->next_;
+                    link(node);
+                    node = next;
+                }
+            }
+
+            // Popped one by one, a callback may insert or remove other timers. Timers inserted
+            // as already due land in the next tick's slot.
+            current_ = tick + 1;
+            int slot = digit(tick, 0);
+            while (TimerNode *node = levels_[0].slots_[slot]) {
+                remove(node);
+                ++fired;
+                node->fire_(node);
+            }
+        }
+        return fired;
+    }
+} // namespace detail
+} // namespace myx_coroutine
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <myx_coroutine/trace.hpp>
+#include <new>
+#include <ostream>
+#include <vector>
+
+namespace myx_coroutine {
+namespace trace {
+
+#if MYX_COROUTINE_TRACE
+    namespace {
+        using detail::Ring;
+
+        struct Record {
+            std::uint64_t seq_;
+            std::uint64_t ticks_;
+            const void *id_;
+            std::uint64_t meta_;
+        };
+
+        struct Registry {
+            std::mutex mtx_;
+            std::vector<std::unique_ptr<Ring>> rings_;
+            // Rings whose thread exited, reused by the next thread that records.
+            std::vector<Ring *> free_;
+            std::uint32_t next_tid_ = 1;
+            // The trace starts here, ticks are converted to time relative to this pair.
+            std::uint64_t start_ticks_ = detail::ticks();
+            std::chrono::steady_clock::time_point start_time_ = std::chrono::steady_clock::now();
+        };
+
+        // Leaked, threads may still record while static objects are destroyed.
+        Registry &registry() {
+            static auto *instance = new Registry;
+            return *instance;
+        }
+
+        thread_local bool exiting = false;
+
+        // Hands the thread's ring back when the thread exits.
+        struct RingOwner {
+            ~RingOwner() {
+                exiting = true;
+                detail::tls_ring = nullptr;
+                if (ring_ != nullptr) {
+                    Registry &reg = registry();
+                    std::lock_guard lock(reg.mtx_);
+                    reg.free_.push_back(ring_);
+                }
+            }
+
+            Ring *ring_ = nullptr;
+        };
+
+        void collect(const Ring &ring, std::vector<Record> &records) {
+            auto begin = records.size();
+            for (const detail::Slot &slot : ring.slots()) {
+                std::uint64_t seq = slot.seq_.load(std::memory_order_acquire);
+                if (seq == 0) {
+                    continue;
+                }
+                Record record{
+                    seq,
+                    slot.ticks_.load(std::memory_order_relaxed),
+                    slot.id_.load(std::memory_order_relaxed),
+                    slot.meta_.load(std::memory_order_relaxed),
+                };
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.seq_.load(std::memory_order_relaxed) == seq) {
+                    records.push_back(record);
+                }
+            }
+            // Slots wrap around, begin/end pairs of a thread need its events in order.
+            std::sort(
+                records.begin() + static_cast<std::ptrdiff_t>(begin), records.end(),
+                [](const Record &lhs, const Record &rhs) { return lhs.seq_ < rhs.seq_; }
+            );
+        }
+
+        void write_event(std::ostream &out, const Record &record, double ts) {
+            auto event = static_cast<Event>(record.meta_ & 0xff);
+            out << "{\"pid\":1,\"tid\":" << (record.meta_ >> 8) << ",\"ts\":" << ts << ',';
+            switch (event) {
+                case Event::TaskCreated:
+                    out << R"("ph":"b","cat":"task","name":"task","id":")" << record.id_ << "\"}";
+                    break;
+                case Event::TaskAwait:
+                    out << R"("ph":"i","s":"t","name":"await","args":{"promise":")"
+                        << record.id_ << "\"}}";
+                    break;
+                case Event::TaskFinished:
+                    out << R"("ph":"e","cat":"task","name":"task","id":")" << record.id_ << "\"}";
+                    break;
+                case Event::JobBegin:
+                    if (record.id_ == nullptr) {
+                        out << R"("ph":"B","name":"job"})";
+                    } else {
+                        out << R"("ph":"B","name":"job","args":{"job":")" << record.id_ << "\"}}";
+                    }
+                    break;
+                case Event::JobEnd: out << R"("ph":"E","name":"job"})"; break;
+            }
+        }
+    } // namespace
+
+    Ring *detail::acquire_ring() noexcept {
+        if (exiting) {
+            return nullptr;
+        }
+        thread_local RingOwner owner;
+        Registry &reg = registry();
+        std::lock_guard lock(reg.mtx_);
+        try {
+            if (reg.free_.empty()) {
+                reg.rings_.push_back(std::make_unique<Ring>());
+                reg.free_.push_back(reg.rings_.back().get());
+            }
+        } catch (const std::bad_alloc &) {
+            return nullptr;
+        }
+        owner.ring_ = reg.free_.back();
+        reg.free_.pop_back();
+        owner.ring_->set_tid(reg.next_tid_++);
+        tls_ring = owner.ring_;
+        return owner.ring_;
+    }
+
+    void write_chrome_trace(std::ostream &out) {
+        std::vector<Record> records;
+        std::uint64_t start_ticks = 0;
+        double ns_per_tick = 1.0;
+        {
+            Registry &reg = registry();
+            std::lock_guard lock(reg.mtx_);
+            for (const auto &ring : reg.rings_) {
+                collect(*ring, records);
+            }
+            start_ticks = reg.start_ticks_;
+            std::uint64_t now_ticks = detail::ticks();
+            auto elapsed = std::chrono::steady_clock::now() - reg.start_time_;
+            double elapsed_ns = std::chrono::duration<double, std::nano>(elapsed).count();
+            if (now_ticks > start_ticks) {
+                ns_per_tick = elapsed_ns / static_cast<double>(now_ticks - start_ticks);
+            }
+        }
+
+        auto flags = out.flags();
+        auto precision = out.precision();
+        out << std::fixed;
+        out.precision(3);
+        out << "{\"traceEvents\":[";
+        const char *separator = "\n";
+        for (const Record &record : records) {
+            std::uint64_t ticks = record.ticks_ > start_ticks ? record.ticks_ - start_ticks : 0;
+            out << separator;
+            write_event(out, record, static_cast<double>(ticks) * ns_per_tick / 1000.0);
+            separator = ",\n";
+        }
+        out << "\n]}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+#else
+    void write_chrome_trace(std::ostream &out) { out << "{\"traceEvents\":[]}\n"; }
+#endif
+
+    bool write_chrome_trace(const char *path) {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        write_chrome_trace(out);
+        return static_cast<bool>(out.flush());
+    }
+} // namespace trace
+} // namespace myx_coroutine
@@ -0,0 +1,162 @@
+#include "myx_coroutine/asio_bridge.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include <asio.hpp>
+#include <chrono>
+#include <exception>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       AsioBridgeTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using namespace std::chrono_literals;
+using asio::ip::tcp;
+
+TEST_F(TEST_NAME, AwaitTimer) {
+    asio::io_context io_context;
+    bool done = false;
+    auto body = [&]() -> Task<> {
+        asio::steady_timer timer(io_context, 5ms);
+        auto start = std::chrono::steady_clock::now();
+        co_await timer.async_wait(use_task);
+        EXPECT_GE(std::chrono::steady_clock::now() - start, 5ms);
+        done = true;
+    };
+    co_spawn(io_context, body());
+    io_context.run();
+    EXPECT_TRUE(done);
+}
+
+TEST_F(TEST_NAME, ErrorCodeIsThrown) {
+    asio::io_context io_context;
+    asio::error_code error;
+    auto body = [&]() -> Task<> {
+        asio::steady_timer timer(io_context, 1h);
+        asio::post(io_context, [&] { timer.cancel(); });
+        try {
+            co_await timer.async_wait(use_task);
+        } catch (const asio::system_error &e) {
+            error = e.code();
+        }
+    };
+    co_spawn(io_context, body());
+    io_context.run();
+    EXPECT_EQ(error, asio::error::operation_aborted);
+}
+
+TEST_F(TEST_NAME, Echo) {
+    asio::io_context io_context;
+    tcp::acceptor acceptor(io_context, tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    std::string reply;
+
+    auto server = [&]() -> Task<> {
+        tcp::socket socket = co_await acceptor.async_accept(use_task);
+        char data[64];
+        std::size_t n = co_await socket.async_read_some(asio::buffer(data), use_task);
+        co_await asio::async_write(socket, asio::buffer(data, n), use_task);
+    };
+    auto client = [&]() -> Task<> {
+        tcp::socket socket(io_context);
+        co_await socket.async_connect(acceptor.local_endpoint(), use_task);
+        co_await asio::async_write(socket, asio::buffer(std::string("hello")), use_task);
+        reply.resize(5);
+        co_await asio::async_read(socket, asio::buffer(reply), use_task);
+    };
+    co_spawn(io_context, server());
+    co_spawn(io_context, client());
+    io_context.run();
+    EXPECT_EQ(reply, "hello");
+}
+
+TEST_F(TEST_NAME, CompletionHandler) {
+    asio::io_context io_context;
+    auto answer = []() -> Task<int> {
+        co_return 42;
+    };
+    auto fail = []() -> Task<int> {
+        throw std::runtime_error("fail");
+        co_return 0;
+    };
+
+    int value = 0;
+    std::exception_ptr exception;
+    co_spawn(io_context, answer(), [&](std::exception_ptr e, int v) {
+        EXPECT_FALSE(e);
+        value = v;
+    });
+    co_spawn(io_context, fail(), [&](std::exception_ptr e, int) { exception = e; });
+    io_context.run();
+    EXPECT_EQ(value, 42);
+    EXPECT_TRUE(exception);
+}
+
+// The task is away on a pool when the loop runs out of Asio work, the spawn keeps `run()`
+// going until its handler ran.
+TEST_F(TEST_NAME, SpawnedTaskHopsToPool) {
+    asio::io_context io_context;
+    coroutine::ThreadPool pool(2);
+    auto hop = [](coroutine::ThreadPool &pool) -> Task<int> {
+        co_await pool.schedule();
+        std::this_thread::sleep_for(10ms);
+        co_return 42;
+    };
+    int value = 0;
+    co_spawn(io_context, hop(pool), [&](std::exception_ptr e, int v) {
+        EXPECT_FALSE(e);
+        value = v;
+    });
+    io_context.run();
+    EXPECT_EQ(value, 42);
+
+    int awaited = 0;
+    auto body = [&]() -> asio::awaitable<void> {
+        awaited = co_await co_spawn(io_context, hop(pool), asio::use_awaitable);
+    };
+    io_context.restart();
+    asio::co_spawn(io_context, body(), asio::detached);
+    io_context.run();
+    EXPECT_EQ(awaited, 42);
+}
+
+TEST_F(TEST_NAME, AwaitTaskFromAwaitable) {
+    asio::io_context io_context;
+    auto twice = [](int x) -> Task<int> {
+        co_return x * 2;
+    };
+    int result = 0;
+    auto body = [&]() -> asio::awaitable<void> {
+        result = co_await co_spawn(io_context, twice(21), asio::use_awaitable);
+    };
+    asio::co_spawn(io_context, body(), asio::detached);
+    io_context.run();
+    EXPECT_EQ(result, 42);
+}
+} // namespace myx_coroutine
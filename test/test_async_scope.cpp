@@ -0,0 +1,147 @@
+#include "myx_coroutine/async_scope.hpp"
+#include "myx_coroutine/cancellation.hpp"
+#include "myx_coroutine/channel.hpp"
+#include "myx_coroutine/sync_wait.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include <atomic>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       AsyncScopeTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using coroutine::ThreadPool;
+
+TEST_F(TEST_NAME, JoinWaitsForChildren) {
+    AsyncScope scope;
+    Channel<int> ch(0);
+    int finished = 0;
+    auto child = [&]() -> Task<> {
+        co_await ch.recv();
+        ++finished;
+    };
+    auto body = [&]() -> Task<> {
+        for (int i = 0; i < 3; ++i) {
+            scope.spawn(child());
+        }
+        EXPECT_EQ(scope.active(), 3);
+        co_await scope.join();
+        EXPECT_EQ(finished, 3);
+    };
+    auto task = body();
+    task.resume();
+    EXPECT_FALSE(task.is_ready());
+    for (int i = 0; i < 3; ++i) {
+        int value = i;
+        EXPECT_TRUE(ch.try_send(value));
+    }
+    // The last child to finish resumed the joiner.
+    EXPECT_TRUE(task.is_ready());
+    EXPECT_EQ(scope.active(), 0);
+
+    // Nothing to wait for, and the scope can be reused.
+    auto empty = [&]() -> Task<> {
+        co_await scope.join();
+    };
+    sync_wait(empty());
+}
+
+TEST_F(TEST_NAME, ManyChildrenOnPool) {
+    ThreadPool pool(4);
+    AsyncScope scope;
+    std::atomic<int> count{0};
+    auto child = [&]() -> Task<> {
+        co_await pool.schedule();
+        count.fetch_add(1, std::memory_order_relaxed);
+    };
+    // Children spawn grandchildren while the join is pending.
+    auto parent = [&]() -> Task<> {
+        co_await pool.schedule();
+        for (int i = 0; i < 10; ++i) {
+            scope.spawn(child());
+        }
+    };
+    auto body = [&]() -> Task<> {
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < 100; ++i) {
+                scope.spawn(parent());
+            }
+            co_await scope.join();
+            EXPECT_EQ(count.load(), (round + 1) * 1000);
+        }
+    };
+    sync_wait(body());
+}
+
+TEST_F(TEST_NAME, FirstExceptionIsRethrown) {
+    AsyncScope scope;
+    auto fail = []() -> Task<> {
+        throw std::runtime_error("child");
+        co_return;
+    };
+    auto ok = []() -> Task<> {
+        co_return;
+    };
+    auto body = [&]() -> Task<> {
+        scope.spawn(ok());
+        scope.spawn(fail());
+        scope.spawn(fail());
+        co_await scope.join();
+    };
+    EXPECT_THROW(sync_wait(body()), std::runtime_error);
+    // Reported once.
+    auto again = [&]() -> Task<> {
+        co_await scope.join();
+    };
+    sync_wait(again());
+}
+
+TEST_F(TEST_NAME, RequestStopCancelsChildren) {
+    AsyncScope scope;
+    Channel<int> ch;
+    int cancelled = 0;
+    auto child = [&]() -> Task<> {
+        try {
+            co_await ch.recv();
+        } catch (const OperationCancelled &) {
+            ++cancelled;
+        }
+    };
+    auto body = [&]() -> Task<> {
+        for (int i = 0; i < 4; ++i) {
+            scope.spawn(child());
+        }
+        scope.request_stop();
+        co_await scope.join();
+    };
+    sync_wait(body());
+    EXPECT_EQ(cancelled, 4);
+}
+} // namespace myx_coroutine
@@ -0,0 +1,200 @@
+#include "myx_coroutine/async_condition_variable.hpp"
+#include "myx_coroutine/async_mutex.hpp"
+#include "myx_coroutine/async_semaphore.hpp"
+#include "myx_coroutine/sync_wait.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include "myx_coroutine/when_all.hpp"
+#include <atomic>
+#include <deque>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       AsyncSyncTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using coroutine::ThreadPool;
+
+TEST_F(TEST_NAME, MutexHandsOffInOrder) {
+    AsyncMutex mutex;
+    std::vector<int> order;
+    auto locker = [&](int id) -> Task<> {
+        auto guard = co_await mutex.scoped_lock();
+        order.push_back(id);
+    };
+
+    ASSERT_TRUE(mutex.try_lock());
+    EXPECT_FALSE(mutex.try_lock());
+    std::vector<Task<>> tasks;
+    for (int i = 0; i < 4; ++i) {
+        tasks.push_back(locker(i));
+        tasks.back().resume();
+    }
+    EXPECT_TRUE(order.empty());
+
+    // Every unlock passes the mutex on to the next waiter, the last one frees it.
+    mutex.unlock();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+    for (auto &task : tasks) {
+        EXPECT_TRUE(task.is_ready());
+    }
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_F(TEST_NAME, MutexContended) {
+    ThreadPool pool(4, ThreadPool::Scheduling::WorkStealing);
+    AsyncMutex mutex;
+    long counter = 0;
+    auto worker = [&]() -> Task<> {
+        for (int i = 0; i < 2000; ++i) {
+            co_await pool.schedule();
+            co_await mutex.lock();
+            long seen = counter;
+            counter = seen + 1;
+            mutex.unlock();
+        }
+    };
+    auto all = [&]() -> Task<> {
+        std::vector<Task<>> tasks;
+        for (int i = 0; i < 8; ++i) {
+            tasks.push_back(worker());
+        }
+        co_await when_all(std::move(tasks));
+    };
+    sync_wait(all());
+    EXPECT_EQ(counter, 8 * 2000);
+}
+
+TEST_F(TEST_NAME, SemaphoreLimitsConcurrency) {
+    ThreadPool pool(4);
+    AsyncSemaphore semaphore(3);
+    std::atomic<int> inside{0};
+    std::atomic<int> max_inside{0};
+    auto worker = [&]() -> Task<> {
+        for (int i = 0; i < 200; ++i) {
+            co_await pool.schedule();
+            co_await semaphore.acquire();
+            int now = inside.fetch_add(1) + 1;
+            int max = max_inside.load();
+            while (now > max && !max_inside.compare_exchange_weak(max, now)) {
+            }
+            co_await pool.schedule();
+            inside.fetch_sub(1);
+            semaphore.release();
+        }
+    };
+    auto all = [&]() -> Task<> {
+        std::vector<Task<>> tasks;
+        for (int i = 0; i < 16; ++i) {
+            tasks.push_back(worker());
+        }
+        co_await when_all(std::move(tasks));
+    };
+    sync_wait(all());
+    EXPECT_LE(max_inside.load(), 3);
+    EXPECT_EQ(semaphore.available(), 3);
+}
+
+TEST_F(TEST_NAME, SemaphoreRelease) {
+    AsyncSemaphore semaphore(0);
+    EXPECT_FALSE(semaphore.try_acquire());
+    int acquired = 0;
+    auto waiter = [&]() -> Task<> {
+        co_await semaphore.acquire();
+        ++acquired;
+    };
+    std::vector<Task<>> tasks;
+    for (int i = 0; i < 3; ++i) {
+        tasks.push_back(waiter());
+        tasks.back().resume();
+    }
+    EXPECT_EQ(acquired, 0);
+
+    semaphore.release(2);
+    EXPECT_EQ(acquired, 2);
+    EXPECT_EQ(semaphore.available(), 0);
+    semaphore.release(3);
+    EXPECT_EQ(acquired, 3);
+    EXPECT_EQ(semaphore.available(), 2);
+}
+
+TEST_F(TEST_NAME, ConditionVariableQueue) {
+    ThreadPool pool(4);
+    AsyncMutex mutex;
+    AsyncConditionVariable not_empty;
+    std::deque<int> queue;
+    bool closed = false;
+
+    auto consumer = [&]() -> Task<long> {
+        co_await pool.schedule();
+        long sum = 0;
+        auto guard = co_await mutex.scoped_lock();
+        while (true) {
+            co_await not_empty.wait(mutex, [&] { return !queue.empty() || closed; });
+            if (queue.empty()) {
+                co_return sum;
+            }
+            sum += queue.front();
+            queue.pop_front();
+        }
+    };
+    auto producer = [&]() -> Task<> {
+        for (int i = 1; i <= 1000; ++i) {
+            co_await pool.schedule();
+            {
+                auto guard = co_await mutex.scoped_lock();
+                queue.push_back(i);
+            }
+            not_empty.notify_one();
+        }
+        {
+            auto guard = co_await mutex.scoped_lock();
+            closed = true;
+        }
+        not_empty.notify_all();
+    };
+    auto consumers = [&]() -> Task<long> {
+        std::vector<Task<long>> tasks;
+        for (int i = 0; i < 4; ++i) {
+            tasks.push_back(consumer());
+        }
+        long total = 0;
+        for (long sum : co_await when_all(std::move(tasks))) {
+            total += sum;
+        }
+        co_return total;
+    };
+    auto all = [&]() -> Task<long> {
+        auto [total, unit] = co_await when_all(consumers(), producer());
+        co_return total;
+    };
+    EXPECT_EQ(sync_wait(all()), 1000L * 1001 / 2);
+}
+} // namespace myx_coroutine
@@ -0,0 +1,324 @@
+#include "myx_coroutine/cancellation.hpp"
+#include "myx_coroutine/channel.hpp"
+#include "myx_coroutine/sync_wait.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include "myx_coroutine/when_all.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <stop_token>
+#include <vector>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       ChannelTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using coroutine::ThreadPool;
+
+TEST_F(TEST_NAME, BoundedSuspendsWhenFull) {
+    Channel<int> ch(2);
+    int sent = 0;
+    auto producer = [&]() -> Task<> {
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_TRUE(co_await ch.send(i));
+            ++sent;
+        }
+    };
+    auto task = producer();
+    task.resume();
+    EXPECT_EQ(sent, 2);
+    EXPECT_EQ(ch.size(), 2);
+
+    // Every receive makes room for the suspended sender, which refills the buffer.
+    std::vector<int> received;
+    for (int i = 0; i < 5; ++i) {
+        auto value = ch.try_recv();
+        ASSERT_TRUE(value);
+        received.push_back(*value);
+    }
+    EXPECT_TRUE(task.is_ready());
+    EXPECT_EQ(received, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_FALSE(ch.try_recv());
+}
+
+TEST_F(TEST_NAME, Rendezvous) {
+    Channel<std::unique_ptr<int>> ch(0);
+    auto value = std::make_unique<int>(7);
+    EXPECT_FALSE(ch.try_send(value));
+    EXPECT_TRUE(value);
+
+    std::optional<std::unique_ptr<int>> received;
+    auto receiver = [&]() -> Task<> {
+        received = co_await ch.recv();
+    };
+    auto task = receiver();
+    task.resume();
+    EXPECT_FALSE(received);
+    // Handed straight to the waiting receiver.
+    EXPECT_TRUE(ch.try_send(value));
+    ASSERT_TRUE(received && *received);
+    EXPECT_EQ(**received, 7);
+}
+
+TEST_F(TEST_NAME, CloseDrains) {
+    Channel<int> ch;
+    for (int i = 0; i < 3; ++i) {
+        int value = i;
+        EXPECT_TRUE(ch.try_send(value));
+    }
+    ch.close();
+    int late = 3;
+    EXPECT_FALSE(ch.try_send(late));
+
+    auto body = [&]() -> Task<std::vector<int>> {
+        std::vector<int> values;
+        while (auto value = co_await ch.recv()) {
+            values.push_back(*value);
+        }
+        EXPECT_FALSE(co_await ch.send(4));
+        co_return values;
+    };
+    EXPECT_EQ(sync_wait(body()), (std::vector<int>{0, 1, 2}));
+}
+
+TEST_F(TEST_NAME, CloseWakesWaiters) {
+    Channel<int> ch(1);
+    Channel<int> full(1);
+    std::optional<int> received = 1;
+    bool sent = true;
+    auto receiver = [&]() -> Task<> {
+        received = co_await ch.recv();
+    };
+    auto sender = [&]() -> Task<> {
+        sent = co_await full.send(2);
+    };
+
+    auto waiting_receiver = receiver();
+    waiting_receiver.resume();
+    ch.close();
+    EXPECT_TRUE(waiting_receiver.is_ready());
+    EXPECT_FALSE(received);
+
+    int value = 1;
+    EXPECT_TRUE(full.try_send(value));
+    auto waiting_sender = sender();
+    waiting_sender.resume();
+    full.close();
+    EXPECT_TRUE(waiting_sender.is_ready());
+    EXPECT_FALSE(sent);
+    EXPECT_EQ(full.try_recv(), 1);
+    EXPECT_FALSE(full.try_recv());
+}
+
+TEST_F(TEST_NAME, RecvBatch) {
+    Channel<int> ch(16);
+    auto body = [&]() -> Task<std::vector<std::size_t>> {
+        std::vector<std::size_t> sizes;
+        for (int i = 0; i < 10; ++i) {
+            co_await ch.send(i);
+        }
+        ch.close();
+        while (true) {
+            auto batch = co_await ch.recv_batch(4);
+            if (batch.empty()) {
+                break;
+            }
+            sizes.push_back(batch.size());
+        }
+        co_return sizes;
+    };
+    EXPECT_EQ(sync_wait(body()), (std::vector<std::size_t>{4, 4, 2}));
+}
+
+TEST_F(TEST_NAME, Pipeline) {
+    ThreadPool pool(4);
+    constexpr int kCount = 20000;
+    Channel<int> first(8);
+    Channel<int> second(8);
+
+    auto producer = [&]() -> Task<> {
+        co_await pool.schedule();
+        for (int i = 1; i <= kCount; ++i) {
+            co_await first.send(i);
+        }
+        first.close();
+    };
+    auto stage = [&]() -> Task<> {
+        co_await pool.schedule();
+        while (auto value = co_await first.recv()) {
+            co_await second.send(*value * 2);
+        }
+    };
+    auto stages = [&]() -> Task<> {
+        std::vector<Task<>> tasks;
+        for (int i = 0; i < 3; ++i) {
+            tasks.push_back(stage());
+        }
+        co_await when_all(std::move(tasks));
+        second.close();
+    };
+    auto consumer = [&]() -> Task<long> {
+        co_await pool.schedule();
+        long sum = 0;
+        while (true) {
+            auto batch = co_await second.recv_batch(16);
+            if (batch.empty()) {
+                co_return sum;
+            }
+            sum = std::accumulate(batch.begin(), batch.end(), sum);
+        }
+    };
+    auto all = [&]() -> Task<long> {
+        auto [unit, unit2, sum] = co_await when_all(producer(), stages(), consumer());
+        co_return sum;
+    };
+    EXPECT_EQ(sync_wait(all()), 2L * kCount * (kCount + 1) / 2);
+}
+
+TEST_F(TEST_NAME, CancelWaiters) {
+    Channel<int> ch(1);
+    std::stop_source source;
+    bool cancelled = false;
+    auto receiver = [&]() -> Task<> {
+        try {
+            co_await ch.recv();
+        } catch (const OperationCancelled &) {
+            cancelled = true;
+        }
+    };
+    auto waiting_receiver = receiver();
+    waiting_receiver.set_stop_token(source.get_token());
+    waiting_receiver.resume();
+    EXPECT_FALSE(waiting_receiver.is_ready());
+    source.request_stop();
+    EXPECT_TRUE(waiting_receiver.is_ready());
+    EXPECT_TRUE(cancelled);
+
+    // No longer queued, the value stays in the buffer.
+    int value = 1;
+    EXPECT_TRUE(ch.try_send(value));
+    EXPECT_EQ(ch.size(), 1);
+
+    std::stop_source sender_source;
+    cancelled = false;
+    auto sender = [&]() -> Task<> {
+        try {
+            co_await ch.send(2);
+        } catch (const OperationCancelled &) {
+            cancelled = true;
+        }
+    };
+    auto waiting_sender = sender();
+    waiting_sender.set_stop_token(sender_source.get_token());
+    waiting_sender.resume();
+    EXPECT_FALSE(waiting_sender.is_ready());
+    sender_source.request_stop();
+    EXPECT_TRUE(cancelled);
+    EXPECT_EQ(ch.try_recv(), 1);
+    EXPECT_FALSE(ch.try_recv());
+}
+
+TEST_F(TEST_NAME, SpscRing) {
+    SpscChannel<int> ch(5);
+    EXPECT_EQ(ch.capacity(), 8);
+    for (int i = 0; i < 8; ++i) {
+        int value = i;
+        EXPECT_TRUE(ch.try_send(value));
+    }
+    int extra = 8;
+    EXPECT_FALSE(ch.try_send(extra));
+    EXPECT_EQ(ch.try_recv(), 0);
+    EXPECT_TRUE(ch.try_send(extra));
+
+    std::vector<int> values;
+    EXPECT_EQ(ch.try_recv_batch(values, 100), 8);
+    EXPECT_EQ(values, (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}));
+    EXPECT_FALSE(ch.try_recv());
+}
+
+TEST_F(TEST_NAME, SpscCancelRecv) {
+    SpscChannel<int> ch(4);
+    std::stop_source source;
+    bool cancelled = false;
+    auto receiver = [&]() -> Task<> {
+        try {
+            co_await ch.recv();
+        } catch (const OperationCancelled &) {
+            cancelled = true;
+        }
+    };
+    auto task = receiver();
+    task.set_stop_token(source.get_token());
+    task.resume();
+    EXPECT_FALSE(task.is_ready());
+    source.request_stop();
+    EXPECT_TRUE(task.is_ready());
+    EXPECT_TRUE(cancelled);
+
+    // The slot is free again, a send does not try to wake the cancelled receiver.
+    int value = 3;
+    EXPECT_TRUE(ch.try_send(value));
+    EXPECT_EQ(ch.try_recv(), 3);
+}
+
+TEST_F(TEST_NAME, SpscAcrossThreads) {
+    ThreadPool pool(2);
+    constexpr int kCount = 100000;
+    SpscChannel<int> ch(64);
+
+    auto producer = [&]() -> Task<> {
+        co_await pool.schedule();
+        for (int i = 0; i < kCount; ++i) {
+            EXPECT_TRUE(co_await ch.send(i));
+        }
+        ch.close();
+    };
+    auto consumer = [&]() -> Task<bool> {
+        co_await pool.schedule();
+        int expected = 0;
+        bool in_order = true;
+        while (true) {
+            auto batch = co_await ch.recv_batch(32);
+            if (batch.empty()) {
+                break;
+            }
+            for (int value : batch) {
+                in_order = in_order && value == expected++;
+            }
+        }
+        co_return in_order && expected == kCount;
+    };
+    auto all = [&]() -> Task<bool> {
+        auto [unit, ok] = co_await when_all(producer(), consumer());
+        co_return ok;
+    };
+    EXPECT_TRUE(sync_wait(all()));
+}
+} // namespace myx_coroutine
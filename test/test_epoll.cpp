@@ -0,0 +1,373 @@
+#include "myx_coroutine/cancellation.hpp"
+#include "myx_coroutine/epoll_context.hpp"
+#include "myx_coroutine/task.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       EpollTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using namespace std::chrono_literals;
+
+namespace {
+    Task<> echo(EpollContext &io, int fd) {
+        char buffer[256];
+        int n;
+        while ((n = co_await io.recv(fd, buffer, sizeof(buffer))) > 0) {
+            co_await io.send(fd, buffer, n);
+        }
+        co_await io.close(fd);
+    }
+
+    Task<> ping(EpollContext &io, int fd, int rounds, int &replies) {
+        for (int i = 0; i < rounds; ++i) {
+            std::string message = "ping " + std::to_string(i);
+            EXPECT_EQ(co_await io.send(fd, message.data(), message.size()), message.size());
+            char buffer[256];
+            int n = co_await io.recv(fd, buffer, sizeof(buffer));
+            EXPECT_EQ(std::string(buffer, n), message);
+            ++replies;
+        }
+        co_await io.close(fd);
+    }
+} // namespace
+
+TEST_F(TEST_NAME, PipeReadWrite) {
+    EpollContext io;
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    std::string received;
+    auto reader = [&]() -> Task<> {
+        char buffer[64];
+        int n = co_await io.read(fds[0], buffer, sizeof(buffer));
+        received.assign(buffer, n);
+        co_await io.close(fds[0]);
+    };
+    auto writer = [&]() -> Task<> {
+        const char message[] = "hello";
+        EXPECT_EQ(co_await io.write(fds[1], message, 5), 5);
+        co_await io.close(fds[1]);
+    };
+    io.spawn(reader());
+    io.spawn(writer());
+    io.run();
+
+    EXPECT_EQ(received, "hello");
+    EXPECT_EQ(io.pending(), 0);
+}
+
+TEST_F(TEST_NAME, SocketPairEcho) {
+    EpollContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    int replies = 0;
+    io.spawn(echo(io, fds[0]));
+    io.spawn(ping(io, fds[1], 100, replies));
+    io.run();
+
+    EXPECT_EQ(replies, 100);
+}
+
+TEST_F(TEST_NAME, AcceptConnect) {
+    EpollContext io;
+    int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr *>(&addr), addrlen), 0);
+    ASSERT_EQ(::listen(listener, 16), 0);
+    ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &addrlen), 0);
+
+    constexpr int kClients = 8;
+    int replies = 0;
+    auto server = [&]() -> Task<> {
+        for (int i = 0; i < kClients; ++i) {
+            int fd = co_await io.accept(listener);
+            EXPECT_GE(fd, 0);
+            io.spawn(echo(io, fd));
+        }
+        co_await io.close(listener);
+    };
+    auto client = [&]() -> Task<> {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        EXPECT_EQ(co_await io.connect(fd, reinterpret_cast<sockaddr *>(&addr), addrlen), 0);
+        co_await ping(io, fd, 10, replies);
+    };
+    io.spawn(server());
+    for (int i = 0; i < kClients; ++i) {
+        io.spawn(client());
+    }
+    io.run();
+
+    EXPECT_EQ(replies, kClients * 10);
+}
+
+TEST_F(TEST_NAME, ErrorsAreNegativeErrno) {
+    EpollContext io;
+    int result = 0;
+    auto body = [&]() -> Task<> {
+        char buffer[8];
+        result = co_await io.read(-1, buffer, sizeof(buffer));
+    };
+    io.spawn(body());
+    io.run();
+
+    EXPECT_EQ(result, -EBADF);
+}
+
+TEST_F(TEST_NAME, ReadyOperationsDoNotPark) {
+    EpollContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    ASSERT_EQ(::write(fds[1], "abc", 3), 3);
+
+    int received = 0;
+    auto body = [&]() -> Task<> {
+        char buffer[8];
+        received = co_await io.recv(fds[0], buffer, sizeof(buffer));
+    };
+    io.spawn(body());
+    // Completed inline by the first attempt.
+    EXPECT_EQ(received, 3);
+    EXPECT_EQ(io.pending(), 0);
+
+    // Drained now, the next one has to wait for the edge.
+    io.spawn(body());
+    EXPECT_EQ(io.pending(), 1);
+    ASSERT_EQ(::write(fds[1], "de", 2), 2);
+    io.run();
+    EXPECT_EQ(received, 2);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+// A descriptor closed without `io.close`, after `forget`, and its number reused by a new
+// file.
+TEST_F(TEST_NAME, ReusedDescriptorNumber) {
+    EpollContext io;
+    int first[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, first), 0);
+    ASSERT_EQ(::write(first[1], "abc", 3), 3);
+
+    int received = 0;
+    auto body = [&](int fd) -> Task<> {
+        char buffer[8];
+        received = co_await io.recv(fd, buffer, sizeof(buffer));
+    };
+    io.spawn(body(first[0]));
+    EXPECT_EQ(received, 3);
+
+    int fd = first[0];
+    io.forget(first[0]);
+    ::close(first[0]);
+    ::close(first[1]);
+    // The lowest free number is handed out again.
+    int second[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, second), 0);
+    ASSERT_EQ(second[0], fd);
+
+    io.spawn(body(fd));
+    EXPECT_EQ(io.pending(), 1);
+    ASSERT_EQ(::write(second[1], "de", 2), 2);
+    io.run();
+    EXPECT_EQ(received, 2);
+    ::close(fd);
+    ::close(second[1]);
+}
+
+TEST_F(TEST_NAME, LargeTransferWaitsForWritable) {
+    EpollContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    // Much more than the socket buffer, the writer parks until the reader catches up.
+    constexpr std::size_t kSize = 8 << 20;
+    std::string out(kSize, 'x');
+    std::size_t received = 0;
+    auto writer = [&]() -> Task<> {
+        std::size_t sent = 0;
+        while (sent < kSize) {
+            int n = co_await io.send(fds[0], out.data() + sent, kSize - sent);
+            EXPECT_GT(n, 0);
+            sent += n;
+        }
+        co_await io.close(fds[0]);
+    };
+    auto reader = [&]() -> Task<> {
+        char buffer[65536];
+        int n;
+        while ((n = co_await io.recv(fds[1], buffer, sizeof(buffer))) > 0) {
+            received += n;
+        }
+        co_await io.close(fds[1]);
+    };
+    io.spawn(writer());
+    io.spawn(reader());
+    io.run();
+
+    EXPECT_EQ(received, kSize);
+}
+
+TEST_F(TEST_NAME, ConnectRefused) {
+    EpollContext io;
+    // Bound but not listening, nothing accepts on this port.
+    int holder = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    ASSERT_EQ(::bind(holder, reinterpret_cast<sockaddr *>(&addr), addrlen), 0);
+    ASSERT_EQ(::getsockname(holder, reinterpret_cast<sockaddr *>(&addr), &addrlen), 0);
+
+    int result = 0;
+    auto body = [&]() -> Task<> {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        result = co_await io.connect(fd, reinterpret_cast<sockaddr *>(&addr), addrlen);
+        co_await io.close(fd);
+    };
+    io.spawn(body());
+    io.run();
+
+    EXPECT_EQ(result, -ECONNREFUSED);
+    ::close(holder);
+}
+
+TEST_F(TEST_NAME, RegularFile) {
+    EpollContext io;
+    FILE *file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    int fd = ::fileno(file);
+
+    std::string read_back;
+    auto body = [&]() -> Task<> {
+        EXPECT_EQ(co_await io.write(fd, "0123456789", 10, 0), 10);
+        char buffer[4];
+        int n = co_await io.read(fd, buffer, sizeof(buffer), 3);
+        read_back.assign(buffer, n);
+    };
+    io.spawn(body());
+    io.run();
+
+    EXPECT_EQ(read_back, "3456");
+    std::fclose(file);
+}
+
+TEST_F(TEST_NAME, StopFromOtherThread) {
+    EpollContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    // Never completes, the loop would block forever.
+    char buffer[8];
+    auto body = [&]() -> Task<> {
+        co_await io.recv(fds[0], buffer, sizeof(buffer));
+    };
+    io.spawn(body());
+    std::jthread stopper([&] {
+        std::this_thread::sleep_for(20ms);
+        io.stop();
+    });
+    io.run();
+
+    EXPECT_EQ(io.pending(), 1);
+    // Completing the receive lets the task finish before the context goes away.
+    ASSERT_EQ(::write(fds[1], "x", 1), 1);
+    io.run();
+    EXPECT_EQ(io.pending(), 0);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(TEST_NAME, CancelParkedRecv) {
+    EpollContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    std::stop_source source;
+    int received = 0;
+    bool cancelled = false;
+    auto body = [&]() -> Task<> {
+        char buffer[8];
+        try {
+            received = co_await io.recv(fds[0], buffer, sizeof(buffer));
+        } catch (const OperationCancelled &) {
+            cancelled = true;
+        }
+    };
+    auto task = body();
+    task.set_stop_token(source.get_token());
+    io.spawn(std::move(task));
+    std::jthread stopper([&] {
+        std::this_thread::sleep_for(20ms);
+        source.request_stop();
+    });
+    io.run();
+    EXPECT_TRUE(cancelled);
+    EXPECT_EQ(io.pending(), 0);
+
+    // The descriptor is free for the next receive, and a stopped token fails right away.
+    ASSERT_EQ(::write(fds[1], "abc", 3), 3);
+    io.spawn(body());
+    io.run();
+    EXPECT_EQ(received, 3);
+    cancelled = false;
+    auto stopped = body();
+    stopped.set_stop_token(source.get_token());
+    io.spawn(std::move(stopped));
+    io.run();
+    EXPECT_TRUE(cancelled);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(TEST_NAME, SpawnedExceptionIsRethrown) {
+    EpollContext io;
+    auto body = [&]() -> Task<> {
+        co_await io.close(-1);
+        throw std::runtime_error("spawned");
+    };
+    io.spawn(body());
+    EXPECT_THROW(io.run(), std::runtime_error);
+}
+} // namespace myx_coroutine
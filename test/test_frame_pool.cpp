@@ -0,0 +1,198 @@
+#include "myx_coroutine/frame_pool.hpp"
+#include "myx_coroutine/generator.hpp"
+#include "myx_coroutine/task.hpp"
+#include <array>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       FramePoolTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+TEST_F(TEST_NAME, ReuseOnSameThread) {
+    auto before = frame_pool_stats();
+    void *first = detail::frame_pool_allocate(200);
+    detail::frame_pool_deallocate(first);
+    void *second = detail::frame_pool_allocate(200);
+    auto after = frame_pool_stats();
+
+    EXPECT_EQ(first, second);
+    EXPECT_GE(after.hits, before.hits + 1);
+    detail::frame_pool_deallocate(second);
+}
+
+TEST_F(TEST_NAME, AlignedToDefaultNewAlignment) {
+    for (std::size_t size : {1, 17, 100, 1000, 5000}) {
+        void *ptr = detail::frame_pool_allocate(size);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % __STDCPP_DEFAULT_NEW_ALIGNMENT__, 0);
+        detail::frame_pool_deallocate(ptr);
+    }
+}
+
+// Blocks released on another thread go back to their owner through the remote list.
+TEST_F(TEST_NAME, CrossThreadReturn) {
+    constexpr int count = 64;
+    std::vector<void *> blocks;
+    for (int i = 0; i < count; ++i) {
+        blocks.push_back(detail::frame_pool_allocate(300));
+    }
+    auto before = frame_pool_stats();
+    std::thread([&blocks]() {
+        for (void *ptr : blocks) {
+            detail::frame_pool_deallocate(ptr);
+        }
+    }).join();
+    auto after = frame_pool_stats();
+    EXPECT_EQ(after.remote_frees, before.remote_frees + count);
+
+    for (int i = 0; i < count; ++i) {
+        blocks[i] = detail::frame_pool_allocate(300);
+    }
+    EXPECT_EQ(frame_pool_stats().hits, after.hits + count);
+    for (void *ptr : blocks) {
+        detail::frame_pool_deallocate(ptr);
+    }
+}
+
+namespace {
+    // Counts what reaches the upstream resource.
+    class CountingResource : public std::pmr::memory_resource {
+      public:
+        std::size_t allocations_ = 0;
+        std::size_t outstanding_ = 0;
+
+      private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+            ++allocations_;
+            ++outstanding_;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *ptr, std::size_t bytes, std::size_t alignment) override {
+            --outstanding_;
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    Task<int> add(std::allocator_arg_t, std::pmr::polymorphic_allocator<>, int lhs, int rhs) {
+        co_return lhs + rhs;
+    }
+
+    Generator<int> iota(std::allocator_arg_t, std::pmr::polymorphic_allocator<>, int count) {
+        for (int i = 0; i < count; ++i) {
+            co_yield i;
+        }
+    }
+
+    struct Calculator {
+        Task<int> scale(std::allocator_arg_t, std::pmr::polymorphic_allocator<>, int value) {
+            co_return value * factor_;
+        }
+
+        int factor_ = 3;
+    };
+} // namespace
+
+TEST_F(TEST_NAME, TaskFromAllocator) {
+    CountingResource resource;
+    {
+        auto task = add(std::allocator_arg, &resource, 1, 2);
+        EXPECT_EQ(resource.outstanding_, 1);
+        task.resume();
+        EXPECT_EQ(task.promise().get_result(), 3);
+    }
+    EXPECT_EQ(resource.allocations_, 1);
+    EXPECT_EQ(resource.outstanding_, 0);
+}
+
+TEST_F(TEST_NAME, MemberTaskFromAllocator) {
+    CountingResource resource;
+    Calculator calculator;
+    {
+        auto task = calculator.scale(std::allocator_arg, &resource, 5);
+        task.resume();
+        EXPECT_EQ(task.promise().get_result(), 15);
+    }
+    EXPECT_EQ(resource.allocations_, 1);
+    EXPECT_EQ(resource.outstanding_, 0);
+}
+
+TEST_F(TEST_NAME, GeneratorFromAllocator) {
+    CountingResource resource;
+    int sum = 0;
+    for (int value : iota(std::allocator_arg, &resource, 10)) {
+        sum += value;
+    }
+    EXPECT_EQ(sum, 45);
+    EXPECT_EQ(resource.allocations_, 1);
+    EXPECT_EQ(resource.outstanding_, 0);
+}
+
+// All frames of a request come out of one arena, back to back, and go away with it.
+TEST_F(TEST_NAME, RequestArena) {
+    alignas(std::max_align_t) std::array<std::byte, 16 * 1024> buffer;
+    CountingResource upstream;
+    {
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), &upstream);
+        int sum = 0;
+        for (int i = 0; i < 10; ++i) {
+            auto task = add(std::allocator_arg, &arena, i, 1);
+            auto *frame = reinterpret_cast<std::byte *>(&task.promise());
+            EXPECT_GE(frame, buffer.data());
+            EXPECT_LT(frame, buffer.data() + buffer.size());
+            task.resume();
+            sum += task.promise().get_result();
+        }
+        EXPECT_EQ(sum, 55);
+    }
+    EXPECT_EQ(upstream.allocations_, 0);
+}
+
+#if MYX_COROUTINE_FRAME_POOL
+TEST_F(TEST_NAME, TaskFramesArePooled) {
+    auto make_task = []() -> Task<int> {
+        co_return 42;
+    };
+    { auto warm_up = make_task(); }
+
+    auto before = frame_pool_stats();
+    for (int i = 0; i < 100; ++i) {
+        auto task = make_task();
+        task.resume();
+        EXPECT_EQ(task.promise().get_result(), 42);
+    }
+    EXPECT_EQ(frame_pool_stats().hits, before.hits + 100);
+}
+#endif
+} // namespace myx_coroutine
@@ -0,0 +1,362 @@
+#include "myx_coroutine/async_generator.hpp"
+#include "myx_coroutine/chunked_generator.hpp"
+#include "myx_coroutine/generator.hpp"
+#include "myx_coroutine/lib.h"
+#include "myx_coroutine/sync_wait.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include <array>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       GeneratorTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+TEST_F(TEST_NAME, CountTo) {
+    std::vector<int> values;
+    for (int value : count_to(5)) {
+        values.push_back(value);
+    }
+    EXPECT_THAT(values, testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
+namespace {
+    struct Record {
+        explicit Record(int id) : id_(id) {}
+
+        Record(const Record &rhs) : id_(rhs.id_) { ++copies_; }
+
+        Record(Record &&rhs) noexcept : id_(rhs.id_) { ++moves_; }
+
+        int id_;
+        std::array<char, 4096> payload_{};
+        inline static int copies_ = 0;
+        inline static int moves_ = 0;
+    };
+
+} // namespace
+
+// Neither the generator nor the consumer copies what was yielded.
+TEST_F(TEST_NAME, YieldByReference) {
+    auto records = []() -> Generator<Record> {
+        Record record(0);
+        for (int i = 0; i < 3; ++i) {
+            record.id_ = i;
+            co_yield record;
+        }
+        co_yield Record(3);
+    };
+
+    int expected = 0;
+    for (const Record &record : records()) {
+        EXPECT_EQ(record.id_, expected++);
+    }
+    EXPECT_EQ(expected, 4);
+    EXPECT_EQ(Record::copies_, 0);
+    EXPECT_EQ(Record::moves_, 0);
+}
+
+TEST_F(TEST_NAME, ConsumerSeesGeneratorObject) {
+    std::string *yielded = nullptr;
+    auto strings = [&yielded]() -> Generator<std::string &> {
+        std::string value = "hello";
+        yielded = &value;
+        co_yield value;
+    };
+    auto gen = strings();
+    auto it = gen.begin();
+    EXPECT_EQ(&*it, yielded);
+    EXPECT_EQ(it->size(), 5);
+}
+
+namespace {
+    Generator<int> each(const std::vector<int> &values) {
+        for (const int &value : values) {
+            co_yield value;
+        }
+    }
+} // namespace
+
+// Const lvalues are yielded in place, and the consumer only gets read access.
+TEST_F(TEST_NAME, YieldConstLvalue) {
+    static_assert(std::is_same_v<decltype(*count_to(1).begin()), const int &>);
+    const std::vector<int> values{3, 1, 4};
+    std::vector<const int *> seen;
+    for (const int &value : each(values)) {
+        seen.push_back(&value);
+    }
+    EXPECT_THAT(seen, testing::ElementsAre(&values[0], &values[1], &values[2]));
+}
+
+TEST_F(TEST_NAME, MoveGenerator) {
+    auto gen = count_to(3);
+    auto moved = std::move(gen);
+    int sum = 0;
+    for (int value : moved) {
+        sum += value;
+    }
+    EXPECT_EQ(sum, 3);
+}
+namespace {
+    Generator<int> range(int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            co_yield i;
+        }
+    }
+
+    // In-order walk of a complete binary tree over [begin, end).
+    Generator<int> walk(int begin, int end) {
+        if (end - begin <= 1) {
+            if (begin < end) {
+                co_yield begin;
+            }
+            co_return;
+        }
+        int mid = begin + (end - begin) / 2;
+        co_yield elements_of(walk(begin, mid));
+        co_yield elements_of(walk(mid, end));
+    }
+
+    Generator<int> deep(int depth) {
+        if (depth == 0) {
+            co_yield elements_of(range(0, 3));
+            co_return;
+        }
+        co_yield -depth;
+        co_yield elements_of(deep(depth - 1));
+        co_yield depth;
+    }
+} // namespace
+
+TEST_F(TEST_NAME, ElementsOf) {
+    auto outer = []() -> Generator<int> {
+        co_yield 0;
+        co_yield elements_of(range(1, 4));
+        co_yield elements_of(range(4, 4));
+        co_yield 4;
+    };
+    std::vector<int> values;
+    for (int value : outer()) {
+        values.push_back(value);
+    }
+    EXPECT_THAT(values, testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST_F(TEST_NAME, RecursiveWalk) {
+    int expected = 0;
+    for (int value : walk(0, 1000)) {
+        EXPECT_EQ(value, expected++);
+    }
+    EXPECT_EQ(expected, 1000);
+}
+
+TEST_F(TEST_NAME, DeepNesting) {
+    std::vector<int> values;
+    for (int value : deep(20)) {
+        values.push_back(value);
+    }
+    std::vector<int> expected;
+    for (int i = 20; i > 0; --i) {
+        expected.push_back(-i);
+    }
+    expected.insert(expected.end(), {0, 1, 2});
+    for (int i = 1; i <= 20; ++i) {
+        expected.push_back(i);
+    }
+    EXPECT_EQ(values, expected);
+}
+
+TEST_F(TEST_NAME, NestedException) {
+    auto failing = []() -> Generator<int> {
+        co_yield 1;
+        throw std::runtime_error("inner failed");
+    };
+    auto outer = [&failing]() -> Generator<int> {
+        bool failed = false;
+        try {
+            co_yield elements_of(failing());
+        } catch (const std::runtime_error &) {
+            failed = true;
+        }
+        if (failed) {
+            co_yield -1;
+        }
+        co_yield elements_of(failing());
+    };
+
+    std::vector<int> values;
+    EXPECT_THROW(
+        {
+            for (int value : outer()) {
+                values.push_back(value);
+            }
+        },
+        std::runtime_error
+    );
+    EXPECT_THAT(values, testing::ElementsAre(1, -1, 1));
+}
+namespace {
+    Task<int> fetch(coroutine::ThreadPool &pool, int i) {
+        co_await pool.schedule();
+        co_return i * i;
+    }
+
+    AsyncGenerator<int> squares(coroutine::ThreadPool &pool, int count, int &produced) {
+        for (int i = 0; i < count; ++i) {
+            int value = co_await fetch(pool, i);
+            ++produced;
+            co_yield value;
+        }
+    }
+} // namespace
+
+TEST_F(TEST_NAME, AsyncGeneratorNext) {
+    coroutine::ThreadPool pool(2);
+    int produced = 0;
+    auto consume = [](coroutine::ThreadPool &pool, int &produced) -> Task<std::vector<int>> {
+        std::vector<int> values;
+        auto gen = squares(pool, 5, produced);
+        while (co_await gen.next()) {
+            // The producer runs only on demand, one element ahead at most.
+            EXPECT_EQ(produced, static_cast<int>(values.size()) + 1);
+            values.push_back(gen.value());
+        }
+        co_return values;
+    };
+    EXPECT_THAT(sync_wait(consume(pool, produced)), testing::ElementsAre(0, 1, 4, 9, 16));
+}
+
+TEST_F(TEST_NAME, AsyncGeneratorForEach) {
+    coroutine::ThreadPool pool(2);
+    int produced = 0;
+    int sum = 0;
+    sync_wait(for_each(squares(pool, 10, produced), [&sum](int value) { sum += value; }));
+    EXPECT_EQ(sum, 285);
+
+    // The callback may itself be a coroutine.
+    sum = 0;
+    auto add = [&sum, &pool](int value) -> Task<> {
+        co_await pool.schedule();
+        sum += value;
+    };
+    sync_wait(for_each(squares(pool, 10, produced), add));
+    EXPECT_EQ(sum, 285);
+}
+
+TEST_F(TEST_NAME, AsyncGeneratorYieldConstLvalue) {
+    using Reference = decltype(std::declval<AsyncGenerator<int> &>().value());
+    static_assert(std::is_same_v<Reference, const int &>);
+    auto each = [](const std::vector<int> &values) -> AsyncGenerator<int> {
+        for (const int &value : values) {
+            co_yield value;
+        }
+    };
+    auto collect = [](AsyncGenerator<int> source) -> Task<std::vector<const int *>> {
+        auto gen = std::move(source);
+        std::vector<const int *> seen;
+        while (co_await gen.next()) {
+            seen.push_back(&gen.value());
+        }
+        co_return seen;
+    };
+    const std::vector<int> values{3, 1, 4};
+    EXPECT_THAT(
+        sync_wait(collect(each(values))), testing::ElementsAre(&values[0], &values[1], &values[2])
+    );
+}
+
+TEST_F(TEST_NAME, AsyncGeneratorException) {
+    auto failing = []() -> AsyncGenerator<int> {
+        co_yield 1;
+        throw std::runtime_error("source failed");
+    };
+    auto consume = [](AsyncGenerator<int> source) -> Task<int> {
+        auto gen = std::move(source);
+        int count = 0;
+        while (co_await gen.next()) {
+            ++count;
+        }
+        co_return count;
+    };
+    EXPECT_THROW(sync_wait(consume(failing())), std::runtime_error);
+}
+TEST_F(TEST_NAME, ChunkedCountTo) {
+    std::array<int, 16> buffer;
+    std::vector<std::size_t> sizes;
+    int expected = 0;
+    auto gen = count_to_chunked(100);
+    for (std::span<const int> chunk : gen.chunks(buffer)) {
+        sizes.push_back(chunk.size());
+        for (int value : chunk) {
+            EXPECT_EQ(value, expected++);
+        }
+    }
+    EXPECT_EQ(expected, 100);
+    EXPECT_THAT(sizes, testing::ElementsAre(16, 16, 16, 16, 16, 16, 4));
+}
+
+TEST_F(TEST_NAME, ChunkedFlattened) {
+    std::array<int, 7> buffer;
+    for (int n : {0, 1, 7, 50}) {
+        std::vector<int> values;
+        auto gen = count_to_chunked(n);
+        for (int value : gen.elements(buffer)) {
+            values.push_back(value);
+        }
+        ASSERT_EQ(values.size(), n);
+        for (int i = 0; i < n; ++i) {
+            EXPECT_EQ(values[i], i);
+        }
+    }
+}
+
+TEST_F(TEST_NAME, ChunkedException) {
+    auto failing = []() -> ChunkedGenerator<int> {
+        std::span<int> buffer = co_await chunk_buffer;
+        buffer[0] = 1;
+        buffer = co_yield 1;
+        throw std::runtime_error("producer failed");
+    };
+    std::array<int, 4> buffer;
+    int count = 0;
+    auto gen = failing();
+    EXPECT_THROW(
+        {
+            for (int value : gen.elements(buffer)) {
+                count += value;
+            }
+        },
+        std::runtime_error
+    );
+    EXPECT_EQ(count, 1);
+}
+} // namespace myx_coroutine
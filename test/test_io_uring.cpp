@@ -0,0 +1,299 @@
+#include "myx_coroutine/cancellation.hpp"
+#include "myx_coroutine/io_uring_context.hpp"
+#include "myx_coroutine/task.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <sys/socket.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       IoUringTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+        try {
+            IoUringContext probe(4);
+        } catch (const std::system_error &e) {
+            GTEST_SKIP() << "io_uring unavailable: " << e.what();
+        }
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using namespace std::chrono_literals;
+
+namespace {
+    Task<> echo(IoUringContext &io, int fd) {
+        char buffer[256];
+        int n;
+        while ((n = co_await io.recv(fd, buffer, sizeof(buffer))) > 0) {
+            co_await io.send(fd, buffer, n);
+        }
+        co_await io.close(fd);
+    }
+
+    Task<> ping(IoUringContext &io, int fd, int rounds, int &replies) {
+        for (int i = 0; i < rounds; ++i) {
+            std::string message = "ping " + std::to_string(i);
+            EXPECT_EQ(co_await io.send(fd, message.data(), message.size()), message.size());
+            char buffer[256];
+            int n = co_await io.recv(fd, buffer, sizeof(buffer));
+            EXPECT_EQ(std::string(buffer, n), message);
+            ++replies;
+        }
+        co_await io.close(fd);
+    }
+} // namespace
+
+TEST_F(TEST_NAME, PipeReadWrite) {
+    IoUringContext io;
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    std::string received;
+    auto reader = [&]() -> Task<> {
+        char buffer[64];
+        int n = co_await io.read(fds[0], buffer, sizeof(buffer));
+        received.assign(buffer, n);
+        co_await io.close(fds[0]);
+    };
+    auto writer = [&]() -> Task<> {
+        const char message[] = "hello";
+        EXPECT_EQ(co_await io.write(fds[1], message, 5), 5);
+        co_await io.close(fds[1]);
+    };
+    io.spawn(reader());
+    io.spawn(writer());
+    io.run();
+
+    EXPECT_EQ(received, "hello");
+    EXPECT_EQ(io.pending(), 0);
+}
+
+TEST_F(TEST_NAME, SocketPairEcho) {
+    IoUringContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    int replies = 0;
+    io.spawn(echo(io, fds[0]));
+    io.spawn(ping(io, fds[1], 100, replies));
+    io.run();
+
+    EXPECT_EQ(replies, 100);
+}
+
+TEST_F(TEST_NAME, AcceptConnect) {
+    IoUringContext io;
+    int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrlen = sizeof(addr);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr *>(&addr), addrlen), 0);
+    ASSERT_EQ(::listen(listener, 16), 0);
+    ASSERT_EQ(::getsockname(listener, reinterpret_cast<sockaddr *>(&addr), &addrlen), 0);
+
+    constexpr int kClients = 8;
+    int replies = 0;
+    auto server = [&]() -> Task<> {
+        for (int i = 0; i < kClients; ++i) {
+            int fd = co_await io.accept(listener);
+            EXPECT_GE(fd, 0);
+            io.spawn(echo(io, fd));
+        }
+        co_await io.close(listener);
+    };
+    auto client = [&]() -> Task<> {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        EXPECT_EQ(co_await io.connect(fd, reinterpret_cast<sockaddr *>(&addr), addrlen), 0);
+        co_await ping(io, fd, 10, replies);
+    };
+    io.spawn(server());
+    for (int i = 0; i < kClients; ++i) {
+        io.spawn(client());
+    }
+    io.run();
+
+    EXPECT_EQ(replies, kClients * 10);
+}
+
+TEST_F(TEST_NAME, ErrorsAreNegativeErrno) {
+    IoUringContext io;
+    int result = 0;
+    auto body = [&]() -> Task<> {
+        char buffer[8];
+        result = co_await io.read(-1, buffer, sizeof(buffer));
+    };
+    io.spawn(body());
+    io.run();
+
+    EXPECT_EQ(result, -EBADF);
+}
+
+TEST_F(TEST_NAME, MoreOperationsThanEntries) {
+    IoUringContext io(8);
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    // More operations than entries, the queue is flushed early when it fills up.
+    constexpr int kWrites = 32;
+    int written = 0;
+    auto writer = [&]() -> Task<> {
+        char byte = 'x';
+        written += co_await io.send(fds[0], &byte, 1);
+    };
+    for (int i = 0; i < kWrites; ++i) {
+        io.spawn(writer());
+    }
+    EXPECT_EQ(io.pending(), kWrites);
+    io.run();
+
+    EXPECT_EQ(written, kWrites);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+// The kernel stops consuming a batch at an entry it rejects while preparing it, here an
+// accept with invalid flags, so the send queued behind it is left for the next submit.
+TEST_F(TEST_NAME, ShortSubmitIsResubmitted) {
+    IoUringContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    int accepted = 0;
+    int sent = 0;
+    auto bad_accept = [&]() -> Task<> {
+        accepted = co_await io.accept(fds[0], nullptr, nullptr, 0x40000000);
+    };
+    auto sender = [&]() -> Task<> {
+        char byte = 'x';
+        sent = co_await io.send(fds[0], &byte, 1);
+    };
+    io.spawn(bad_accept());
+    io.spawn(sender());
+    // Turns a lost submission into a failure instead of a hang.
+    std::jthread watchdog([&](std::stop_token token) {
+        for (int i = 0; i < 100 && !token.stop_requested(); ++i) {
+            std::this_thread::sleep_for(10ms);
+        }
+        io.stop();
+    });
+    io.run();
+    watchdog.request_stop();
+
+    EXPECT_EQ(accepted, -EINVAL);
+    EXPECT_EQ(sent, 1);
+    EXPECT_EQ(io.pending(), 0);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(TEST_NAME, StopFromOtherThread) {
+    IoUringContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    // Never completes, the loop would block forever.
+    char buffer[8];
+    auto body = [&]() -> Task<> {
+        co_await io.recv(fds[0], buffer, sizeof(buffer));
+    };
+    io.spawn(body());
+    std::jthread stopper([&] {
+        std::this_thread::sleep_for(20ms);
+        io.stop();
+    });
+    io.run();
+
+    EXPECT_EQ(io.pending(), 1);
+    // Completing the receive lets the task finish before the context goes away.
+    ASSERT_EQ(::write(fds[1], "x", 1), 1);
+    io.run();
+    EXPECT_EQ(io.pending(), 0);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(TEST_NAME, CancelParkedRecv) {
+    IoUringContext io;
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+    std::stop_source source;
+    int received = 0;
+    bool cancelled = false;
+    auto body = [&]() -> Task<> {
+        char buffer[8];
+        try {
+            received = co_await io.recv(fds[0], buffer, sizeof(buffer));
+        } catch (const OperationCancelled &) {
+            cancelled = true;
+        }
+    };
+    auto task = body();
+    task.set_stop_token(source.get_token());
+    io.spawn(std::move(task));
+    std::jthread stopper([&] {
+        std::this_thread::sleep_for(20ms);
+        source.request_stop();
+    });
+    io.run();
+    EXPECT_TRUE(cancelled);
+    EXPECT_EQ(io.pending(), 0);
+
+    // The descriptor is free for the next receive, and a stopped token fails right away.
+    ASSERT_EQ(::write(fds[1], "abc", 3), 3);
+    io.spawn(body());
+    io.run();
+    EXPECT_EQ(received, 3);
+    cancelled = false;
+    auto stopped = body();
+    stopped.set_stop_token(source.get_token());
+    io.spawn(std::move(stopped));
+    io.run();
+    EXPECT_TRUE(cancelled);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+TEST_F(TEST_NAME, SpawnedExceptionIsRethrown) {
+    IoUringContext io;
+    auto body = [&]() -> Task<> {
+        co_await io.close(-1);
+        throw std::runtime_error("spawned");
+    };
+    io.spawn(body());
+    EXPECT_THROW(io.run(), std::runtime_error);
+}
+} // namespace myx_coroutine
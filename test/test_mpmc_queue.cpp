@@ -0,0 +1,128 @@
+#include "myx_coroutine/mpmc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       MpmcQueueTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+using coroutine::BoundedMpmcQueue;
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+TEST_F(TEST_NAME, FifoAndBounds) {
+    BoundedMpmcQueue<int> queue(4);
+    EXPECT_TRUE(queue.empty());
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(int{i}));
+    }
+    EXPECT_FALSE(queue.try_push(4)); // full
+    EXPECT_EQ(queue.size(), 4);
+
+    int x = -1;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_pop(x));
+        EXPECT_EQ(x, i);
+    }
+    EXPECT_FALSE(queue.try_pop(x)); // empty
+}
+
+TEST_F(TEST_NAME, MoveOnlyType) {
+    BoundedMpmcQueue<std::unique_ptr<int>> queue(2);
+    queue.push(std::make_unique<int>(42));
+    queue.push(std::make_unique<int>(43)); // left in the queue, released by the destructor
+    std::unique_ptr<int> x;
+    EXPECT_TRUE(queue.pop(x));
+    EXPECT_EQ(*x, 42);
+}
+
+TEST_F(TEST_NAME, StopWakesConsumers) {
+    BoundedMpmcQueue<int> queue(8);
+    std::thread consumer([&queue]() {
+        int x;
+        EXPECT_TRUE(queue.pop(x));
+        EXPECT_EQ(x, 7);
+        EXPECT_FALSE(queue.pop(x));
+    });
+    queue.push(7);
+    queue.stop();
+    consumer.join();
+}
+
+TEST_F(TEST_NAME, StopWakesProducers) {
+    BoundedMpmcQueue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+    std::thread producer([&queue]() { EXPECT_FALSE(queue.push(3)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.stop();
+    producer.join();
+    EXPECT_EQ(queue.size(), 2);
+}
+
+TEST_F(TEST_NAME, MultiProducerMultiConsumer) {
+    constexpr int producer_count = 4;
+    constexpr int consumer_count = 4;
+    constexpr long items_per_producer = 20000;
+    // Small capacity so that both the full and the empty slow paths are exercised.
+    BoundedMpmcQueue<long> queue(16);
+    std::atomic<long> sum = 0;
+    std::atomic<long> popped = 0;
+
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < consumer_count; ++i) {
+        consumers.emplace_back([&]() {
+            long x;
+            while (queue.pop(x)) {
+                sum.fetch_add(x, std::memory_order_relaxed);
+                popped.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producer_count; ++i) {
+        producers.emplace_back([&]() {
+            for (long v = 1; v <= items_per_producer; ++v) {
+                queue.push(long{v});
+            }
+        });
+    }
+    for (auto &t : producers) {
+        t.join();
+    }
+    queue.stop();
+    for (auto &t : consumers) {
+        t.join();
+    }
+
+    EXPECT_EQ(popped.load(), producer_count * items_per_producer);
+    EXPECT_EQ(sum.load(), producer_count * items_per_producer * (items_per_producer + 1) / 2);
+}
+} // namespace myx_coroutine
@@ -1,14 +1,17 @@
 #include "myx_coroutine/promise.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
 #include <chrono>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <latch>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 #include <thread>
 
 namespace myx_coroutine {
 
-#define ENABLE_TEST_NAME 0
+#define ENABLE_TEST_NAME 1
 #define TEST_NAME_       PromiseTest
 
 #if ENABLE_TEST_NAME
@@ -41,7 +44,7 @@ TEST_F(TEST_NAME, simpleTest) {
     int x = 100;
     std::thread t(
         [&](Promise<int> promise, int x) {
-            std::this_thread::sleep_for(500ms);
+            std::this_thread::sleep_for(50ms);
             promise.set_value(x);
         },
         std::move(p), x
@@ -58,7 +61,7 @@ TEST_F(TEST_NAME, setException) {
     const std::string err_msg = "test exception";
 
     std::thread t([&p, &err_msg]() {
-        std::this_thread::sleep_for(500ms);
+        std::this_thread::sleep_for(50ms);
         try {
             throw std::runtime_error(err_msg);
         } catch (...) {
@@ -89,7 +92,7 @@ TEST_F(TEST_NAME, promiseDestroyedWithoutValue) {
     auto f = p.get_future();
 
     std::thread t([p = std::move(p)]() mutable {
-        std::this_thread::sleep_for(500ms);
+        std::this_thread::sleep_for(50ms);
         // destroy promise without setting value(broken promise).
     });
     t.join();
@@ -106,7 +109,7 @@ TEST_F(TEST_NAME, moveSemantics) {
     EXPECT_THROW(p1.set_value(100), std::runtime_error);
 
     std::thread t1([p = std::move(p2)]() mutable {
-        std::this_thread::sleep_for(500ms);
+        std::this_thread::sleep_for(50ms);
         p.set_value(200);
     });
     t1.join();
@@ -121,7 +124,7 @@ TEST_F(TEST_NAME, moveSemantics) {
     EXPECT_THROW(p3.set_value(300), std::runtime_error);
 
     std::thread t2([p = std::move(p4)]() mutable {
-        std::this_thread::sleep_for(500ms);
+        std::this_thread::sleep_for(50ms);
         p.set_value(400);
     });
     t2.join();
@@ -135,7 +138,7 @@ TEST_F(TEST_NAME, voidType) {
     bool flag = false;
 
     std::thread t([&p, &flag]() {
-        std::this_thread::sleep_for(500ms);
+        std::this_thread::sleep_for(50ms);
         flag = true;
         p.set_value(); // No argument for void type
         SPDLOG_INFO("void promise set");
@@ -164,7 +167,7 @@ TEST_F(TEST_NAME, futureBlockUntilReady) {
 
     std::thread t([&p, &thread_started]() {
         thread_started = true;
-        std::this_thread::sleep_for(1s); // Simulate time-consuming operation
+        std::this_thread::sleep_for(200ms); // Simulate time-consuming operation
         p.set_value("hello future");
     });
 
@@ -181,7 +184,7 @@ TEST_F(TEST_NAME, futureBlockUntilReady) {
 
     t.join();
     EXPECT_EQ(result, "hello future");
-    EXPECT_GE(duration, 900); // Ensure to wait for at least close to 1 second (allowing some error)
+    EXPECT_GE(duration, 180); // Ensure to wait for close to the full 200ms (allowing some error)
     SPDLOG_INFO("duration: {}", duration);
 }
 
@@ -192,4 +195,138 @@ TEST_F(TEST_NAME, multipleFuturesShareState) {
     // do not allow multiple calls to get_future
     EXPECT_THROW(auto f2 = p.get_future(), std::runtime_error);
 }
+
+TEST_F(TEST_NAME, waitForTimesOut) {
+    Promise<int> p;
+    auto f = p.get_future();
+
+    auto start = std::chrono::steady_clock::now();
+    f.wait_for(100ms);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 100ms);
+
+    std::thread t([&p]() {
+        std::this_thread::sleep_for(100ms);
+        p.set_value(7);
+    });
+    f.wait_for(10s);
+    EXPECT_EQ(f.get(), 7);
+    t.join();
+}
+
+// Many back-to-back handoffs, with the consumer sometimes parked and sometimes not.
+TEST_F(TEST_NAME, pingPong) {
+    constexpr int rounds = 10000;
+    long sum = 0;
+    for (int i = 0; i < rounds; ++i) {
+        Promise<int> p;
+        auto f = p.get_future();
+        std::thread t([p = std::move(p), i]() mutable { p.set_value(i); });
+        sum += f.get();
+        t.join();
+    }
+    EXPECT_EQ(sum, static_cast<long>(rounds) * (rounds - 1) / 2);
+}
+
+TEST_F(TEST_NAME, awaitFuture) {
+    Promise<int> p;
+    auto f = p.get_future();
+    auto task = [](Future<int> &f) -> Task<int> {
+        co_return co_await f + 1;
+    }(f);
+    task.resume();
+    EXPECT_FALSE(task.is_ready());
+
+    // The coroutine is resumed inline by set_value.
+    p.set_value(41);
+    EXPECT_TRUE(task.is_ready());
+    EXPECT_EQ(task.promise().get_result(), 42);
+}
+
+TEST_F(TEST_NAME, awaitReadyFuture) {
+    Promise<void> p;
+    auto f = p.get_future();
+    p.set_value();
+    auto task = [](Future<void> &f) -> Task<> {
+        co_await f;
+    }(f);
+    task.resume();
+    EXPECT_TRUE(task.is_ready());
+}
+
+TEST_F(TEST_NAME, awaitBrokenPromise) {
+    auto p = std::make_unique<Promise<int>>();
+    auto f = p->get_future();
+    auto task = [](Future<int> &f) -> Task<int> {
+        co_return co_await f;
+    }(f);
+    task.resume();
+    p.reset();
+    EXPECT_THROW(task.promise().get_result(), std::runtime_error);
+}
+
+TEST_F(TEST_NAME, resumeOnExecutor) {
+    Promise<int> p;
+    auto f = p.get_future();
+    std::latch done(1);
+    std::thread::id resumed_on;
+    int result = 0;
+
+    auto pool = std::make_unique<coroutine::ThreadPool>(1);
+    // Named, the coroutine reads its captures through the closure object.
+    auto body = [&](Future<int> &f) -> Task<> {
+        result = co_await f.resume_on(*pool);
+        resumed_on = std::this_thread::get_id();
+        done.count_down();
+    };
+    auto task = body(f);
+    task.resume();
+    p.set_value(7);
+    done.wait();
+    pool.reset();
+
+    EXPECT_EQ(result, 7);
+    EXPECT_NE(resumed_on, std::this_thread::get_id());
+}
+
+TEST_F(TEST_NAME, thenChain) {
+    coroutine::ThreadPool pool(2);
+    Promise<int> p;
+    auto f = p.get_future()
+                 .then(pool, [](int value) { return value * 2; })
+                 .then(pool, [](int value) { return std::to_string(value); });
+    p.set_value(21);
+    EXPECT_EQ(f.get(), "42");
+}
+
+TEST_F(TEST_NAME, thenPropagatesException) {
+    Promise<int> p;
+    bool called = false;
+    auto f = p.get_future().then([&](int) { called = true; });
+    p.set_exception(std::make_exception_ptr(std::runtime_error("failed")));
+    EXPECT_THROW(f.get(), std::runtime_error);
+    EXPECT_FALSE(called);
+}
+
+// Thousands of pending futures are awaited by suspended coroutines, not blocked threads.
+TEST_F(TEST_NAME, manyPendingAwaits) {
+    constexpr int count = 10000;
+    std::vector<Promise<int>> promises(count);
+    std::vector<Future<int>> futures;
+    long sum = 0;
+    auto consume = [&sum](Future<int> &f) -> Task<> {
+        sum += co_await f;
+    };
+    std::vector<std::unique_ptr<Task<>>> tasks;
+    for (int i = 0; i < count; ++i) {
+        futures.push_back(promises[i].get_future());
+    }
+    for (int i = 0; i < count; ++i) {
+        tasks.emplace_back(new Task<>(consume(futures[i])));
+        tasks.back()->resume();
+    }
+    for (int i = 0; i < count; ++i) {
+        promises[i].set_value(i);
+    }
+    EXPECT_EQ(sum, static_cast<long>(count) * (count - 1) / 2);
+}
 } // namespace myx_coroutine
@@ -0,0 +1,196 @@
+#include "myx_coroutine/small_function.hpp"
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <utility>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       SmallFunctionTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+namespace {
+    using Function = coroutine::SmallFunction<int(int), 48>;
+
+    struct Counters {
+        int constructed_ = 0;
+        int destroyed_ = 0;
+        int calls_ = 0;
+    };
+
+    // Counts its own lifetimes, every constructed object must be destroyed exactly once.
+    template<std::size_t Size, bool NothrowMove = true>
+    struct Tracked {
+        explicit Tracked(Counters &counters) : counters_(&counters) { ++counters_->constructed_; }
+
+        Tracked(Tracked &&rhs) noexcept(NothrowMove)
+            : counters_(rhs.counters_)
+            , padding_(rhs.padding_) {
+            ++counters_->constructed_;
+        }
+
+        ~Tracked() { ++counters_->destroyed_; }
+
+        int operator()(int x) {
+            ++counters_->calls_;
+            return x + static_cast<int>(Size);
+        }
+
+        Counters *counters_;
+        std::array<char, Size> padding_{};
+    };
+
+    using Small = Tracked<8>;
+    using Large = Tracked<64>;
+    using ThrowingMove = Tracked<8, false>;
+
+    static_assert(Function::is_stored_inline<Small>());
+    static_assert(!Function::is_stored_inline<Large>());
+    static_assert(!Function::is_stored_inline<ThrowingMove>());
+
+    // Construction, calls and moves; returns how many callables moving the function built.
+    template<typename F>
+    int exercise(Counters &counters) {
+        int built = 0;
+        {
+            Function fn{F(counters)};
+            EXPECT_TRUE(fn);
+            EXPECT_EQ(fn(1), 1 + static_cast<int>(sizeof(F::padding_)));
+            int before = counters.constructed_;
+            Function moved(std::move(fn));
+            built = counters.constructed_ - before;
+            EXPECT_FALSE(fn);
+            EXPECT_TRUE(moved);
+            EXPECT_EQ(moved(2), 2 + static_cast<int>(sizeof(F::padding_)));
+        }
+        EXPECT_EQ(counters.calls_, 2);
+        EXPECT_EQ(counters.destroyed_, counters.constructed_);
+        return built;
+    }
+} // namespace
+
+TEST_F(TEST_NAME, InlineCallableIsRelocated) {
+    Counters counters;
+    // Moving the function move-constructs the callable into the new buffer.
+    EXPECT_EQ(exercise<Small>(counters), 1);
+}
+
+TEST_F(TEST_NAME, LargeCallableGoesToHeap) {
+    Counters counters;
+    // Only the pointer moves.
+    EXPECT_EQ(exercise<Large>(counters), 0);
+}
+
+TEST_F(TEST_NAME, ThrowingMoveGoesToHeap) {
+    Counters counters;
+    EXPECT_EQ(exercise<ThrowingMove>(counters), 0);
+}
+
+TEST_F(TEST_NAME, MoveAssignment) {
+    Counters small;
+    Counters large;
+    {
+        Function a{Small(small)};
+        Function b{Large(large)};
+
+        // The inline callable is destroyed, the heap one changes hands.
+        a = std::move(b);
+        EXPECT_EQ(small.destroyed_, small.constructed_);
+        EXPECT_FALSE(b);
+        EXPECT_EQ(a(0), 64);
+
+        b = Function{Small(small)};
+        a = std::move(b);
+        EXPECT_EQ(large.destroyed_, large.constructed_);
+        EXPECT_EQ(a(0), 8);
+
+        // Self-assignment keeps the callable.
+        Function &self = a;
+        a = std::move(self);
+        EXPECT_EQ(a(0), 8);
+
+        a = nullptr;
+        EXPECT_FALSE(a);
+        EXPECT_EQ(small.destroyed_, small.constructed_);
+
+        // Assigning an empty function empties the target.
+        a = Function{Large(large)};
+        a = Function{};
+        EXPECT_FALSE(a);
+        EXPECT_EQ(large.destroyed_, large.constructed_);
+    }
+    EXPECT_EQ(small.destroyed_, small.constructed_);
+    EXPECT_EQ(large.destroyed_, large.constructed_);
+}
+
+TEST_F(TEST_NAME, EmptyCallables) {
+    EXPECT_FALSE(Function{});
+    EXPECT_FALSE(Function{nullptr});
+    EXPECT_FALSE(Function{std::function<int(int)>{}});
+    int (*null_pointer)(int) = nullptr;
+    EXPECT_FALSE(Function{null_pointer});
+
+    Function from_std{std::function<int(int)>([](int x) { return x * 2; })};
+    EXPECT_TRUE(from_std);
+    EXPECT_EQ(from_std(21), 42);
+    int (*negate)(int) = [](int x) { return -x; };
+    Function from_pointer{negate};
+    EXPECT_EQ(from_pointer(3), -3);
+}
+
+TEST_F(TEST_NAME, ReturnValuesAndArguments) {
+    coroutine::SmallFunction<std::unique_ptr<int>(std::unique_ptr<int>, int)> add{
+        [](std::unique_ptr<int> value, int delta) {
+            *value += delta;
+            return value;
+        }
+    };
+    auto result = add(std::make_unique<int>(40), 2);
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(*result, 42);
+
+    std::string suffix(100, 'x');
+    coroutine::SmallFunction<std::string(const std::string &)> append{
+        [suffix](const std::string &prefix) { return prefix + suffix; }
+    };
+    EXPECT_EQ(append("a").size(), 101);
+
+    int calls = 0;
+    coroutine::SmallFunction<void(int &)> increment{[&calls](int &value) {
+        ++value;
+        ++calls;
+    }};
+    int value = 0;
+    increment(value);
+    increment(value);
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(calls, 2);
+}
+} // namespace myx_coroutine
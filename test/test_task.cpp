@@ -1,7 +1,11 @@
+#include "myx_coroutine/cancellation.hpp"
+#include "myx_coroutine/sync_wait.hpp"
 #include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <spdlog/spdlog.h>
+#include <stop_token>
 
 namespace myx_coroutine {
 
@@ -346,24 +350,94 @@ TEST_F(TEST_NAME, ThrowTest3) {
 //     static_assert(std::is_same_v<decltype(task.promise().get_result()), type&>);
 // }
 
-// TEST_CASE("task doesn't require default constructor", "[task]")
-// {
-//     // https://github.com/jbaldwin/libcoro/issues/163
-//     // Reported issue that the return type required a default constructor.
-//     // This test explicitly creates an object that does not have a default
-//     // constructor to verify that the default constructor isn't required.
+TEST_F(TEST_NAME, NoDefaultConstructorTest) {
+    // https://github.com/jbaldwin/libcoro/issues/163
+    // Reported issue that the return type required a default constructor.
+    // This test explicitly creates an object that does not have a default
+    // constructor to verify that the default constructor isn't required.
 
-//     struct A
-//     {
-//         A(int value) : m_value(value) {}
+    struct A {
+        A(int value) : m_value(value) {}
 
-//         int m_value{};
-//     };
+        int m_value{};
+    };
 
-//     auto make_task = []() -> Task<A> { co_return A(42); };
+    auto make_task = []() -> Task<A> {
+        co_return A(42);
+    };
 
-//     EXPECT_TRUE(coro::sync_wait(make_task()).m_value == 42);
-// }
+    EXPECT_TRUE(sync_wait(make_task()).m_value == 42);
+}
+
+TEST_F(TEST_NAME, SyncWaitTest) {
+    auto inner = []() -> Task<int> {
+        co_return 21;
+    };
+    auto outer = [](auto inner) -> Task<int> {
+        co_return co_await inner() * 2;
+    };
+    EXPECT_EQ(sync_wait(outer(inner)), 42);
+
+    auto nothing = []() -> Task<> {
+        co_return;
+    };
+    sync_wait(nothing());
+
+    auto fail = []() -> Task<int> {
+        throw std::runtime_error{"I always throw."};
+        co_return 0;
+    };
+    EXPECT_THROW(sync_wait(fail()), std::runtime_error);
+}
+
+// The task finishes on a pool thread while the caller is parked.
+TEST_F(TEST_NAME, SyncWaitOnPoolTest) {
+    coroutine::ThreadPool pool(2);
+    auto hop = [](coroutine::ThreadPool &pool) -> Task<std::thread::id> {
+        co_await pool.schedule();
+        std::this_thread::sleep_for(1ms);
+        co_return std::this_thread::get_id();
+    };
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_NE(sync_wait(hop(pool)), std::this_thread::get_id());
+    }
+}
+
+// No delay on the pool side: the caller often sees the task done before it is woken, and
+// leaves while the wake-up is still on its way.
+TEST_F(TEST_NAME, SyncWaitRacesCompletionTest) {
+    coroutine::ThreadPool pool(2);
+    auto hop = [](coroutine::ThreadPool &pool, int i) -> Task<int> {
+        co_await pool.schedule();
+        co_return i;
+    };
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(sync_wait(hop(pool, i)), i);
+    }
+}
+
+// A task without a token of its own sees the one of the task awaiting it.
+TEST_F(TEST_NAME, StopTokenTest) {
+    std::stop_source source;
+    auto child = []() -> Task<bool> {
+        std::stop_token token = co_await get_stop_token();
+        co_return token.stop_requested();
+    };
+    auto parent = [&]() -> Task<bool> {
+        EXPECT_FALSE(co_await child());
+        source.request_stop();
+        co_return co_await child();
+    };
+    auto task = parent();
+    task.set_stop_token(source.get_token());
+    EXPECT_TRUE(sync_wait(std::move(task)));
+
+    auto lone = []() -> Task<bool> {
+        std::stop_token token = co_await get_stop_token();
+        co_return token.stop_possible();
+    };
+    EXPECT_FALSE(sync_wait(lone()));
+}
 
 // TEST_CASE("task supports instantiation with rvalue reference", "[task]")
 // {
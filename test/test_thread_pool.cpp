@@ -0,0 +1,160 @@
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <latch>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       ThreadPoolTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+using coroutine::ThreadPool;
+
+struct TEST_NAME : public testing::TestWithParam<ThreadPool::Scheduling> {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+TEST_P(TEST_NAME, RunAllTasks) {
+    constexpr int task_count = 10000;
+    std::atomic<int> cnt = 0;
+    std::latch done(task_count);
+    {
+        ThreadPool pool(4, GetParam());
+        for (int i = 0; i < task_count; ++i) {
+            pool.push_task([&]() {
+                cnt.fetch_add(1, std::memory_order_relaxed);
+                done.count_down();
+            });
+        }
+        done.wait();
+    }
+    EXPECT_EQ(cnt.load(), task_count);
+}
+
+// Tasks pushed from inside a worker land in that worker's local deque in work-stealing mode.
+TEST_P(TEST_NAME, NestedPush) {
+    constexpr int depth = 12;
+    std::atomic<int> cnt = 0;
+    std::latch done((1 << depth) - 1);
+    {
+        ThreadPool pool(4, GetParam());
+        std::function<void(int)> fork = [&](int level) {
+            cnt.fetch_add(1, std::memory_order_relaxed);
+            if (level + 1 < depth) {
+                pool.push_task([&, level]() { fork(level + 1); });
+                pool.push_task([&, level]() { fork(level + 1); });
+            }
+            done.count_down();
+        };
+        pool.push_task([&]() { fork(0); });
+        done.wait();
+    }
+    EXPECT_EQ(cnt.load(), (1 << depth) - 1);
+}
+
+// Far more tasks than the work-stealing injection ring holds, pushed from outside the pool
+// while its only worker is busy: the push must not block.
+TEST_P(TEST_NAME, PushFromOutsideNeverBlocks) {
+    constexpr int task_count = 20000;
+    std::atomic<int> cnt = 0;
+    std::latch release(1);
+    std::latch done(task_count + 1);
+    {
+        ThreadPool pool(1, GetParam());
+        pool.push_task([&]() {
+            release.wait();
+            done.count_down();
+        });
+        for (int i = 0; i < task_count; ++i) {
+            pool.push_task([&]() {
+                cnt.fetch_add(1, std::memory_order_relaxed);
+                done.count_down();
+            });
+        }
+        release.count_down();
+        done.wait();
+    }
+    EXPECT_EQ(cnt.load(), task_count);
+}
+
+TEST_P(TEST_NAME, DestroyIdlePool) {
+    ThreadPool pool(4, GetParam());
+}
+
+TEST_P(TEST_NAME, ScheduleCoroutine) {
+    constexpr int hops = 1000;
+    const auto caller = std::this_thread::get_id();
+    std::latch done(1);
+    int hopped = 0;
+    bool switched = false;
+
+    auto pool = std::make_unique<ThreadPool>(2, GetParam());
+    // Named, the coroutine reads its captures through the closure object.
+    auto hop = [&](ThreadPool &pool) -> Task<> {
+        for (int i = 0; i < hops; ++i) {
+            co_await pool.schedule();
+            ++hopped;
+        }
+        switched = std::this_thread::get_id() != caller;
+        done.count_down();
+    };
+    auto task = hop(*pool);
+    task.resume();
+    done.wait();
+    // Joining the workers guarantees the coroutine has fully finished before the task is
+    // destroyed.
+    pool.reset();
+
+    EXPECT_TRUE(task.is_ready());
+    EXPECT_EQ(hopped, hops);
+    EXPECT_TRUE(switched);
+}
+
+TEST_P(TEST_NAME, MoveOnlyTask) {
+    std::latch done(1);
+    int result = 0;
+    std::array<char, 16> buffer{};
+    auto fn = [value = std::make_unique<int>(42), buffer, &result, &done]() {
+        result = *value + buffer[0];
+        done.count_down();
+    };
+    static_assert(ThreadPool::Function::is_stored_inline<decltype(fn)>());
+    {
+        ThreadPool pool(2, GetParam());
+        pool.push_task(std::move(fn));
+        done.wait();
+    }
+    EXPECT_EQ(result, 42);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Scheduling,
+    TEST_NAME,
+    testing::Values(ThreadPool::Scheduling::SharedQueue, ThreadPool::Scheduling::WorkStealing)
+);
+} // namespace myx_coroutine
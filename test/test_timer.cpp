@@ -0,0 +1,253 @@
+#include "myx_coroutine/cancellation.hpp"
+#include "myx_coroutine/detached_task.hpp"
+#include "myx_coroutine/sync_wait.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/timer_service.hpp"
+#include "myx_coroutine/timer_wheel.hpp"
+#include "myx_coroutine/when_all.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <latch>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       TimerTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using namespace std::chrono_literals;
+using detail::TimerNode;
+using detail::TimerWheel;
+
+namespace {
+    // Records the tick the wheel was advanced to when it fired.
+    struct TestTimer : TimerNode {
+        TestTimer() noexcept { fire_ = &on_fire; }
+
+        static void on_fire(TimerNode *node) noexcept {
+            auto *self = static_cast<TestTimer *>(node);
+            self->fired_at_ = *self->now_;
+            ++self->fire_count_;
+        }
+
+        std::uint64_t want_ = 0;
+        const std::uint64_t *now_ = nullptr;
+        std::uint64_t fired_at_ = 0;
+        int fire_count_ = 0;
+    };
+} // namespace
+
+TEST_F(TEST_NAME, WheelFiresOnTime) {
+    TimerWheel wheel;
+    std::uint64_t now = 0;
+    std::mt19937_64 rng(42);
+    std::vector<TestTimer> timers(20000);
+    for (auto &timer : timers) {
+        // Spread over several levels, some share slots.
+        timer.want_ = rng() % (1u << (rng() % 28));
+        timer.deadline_ = timer.want_;
+        timer.now_ = &now;
+        wheel.insert(&timer);
+    }
+    EXPECT_EQ(wheel.size(), timers.size());
+
+    while (wheel.size() != 0) {
+        now += rng() % 5000;
+        wheel.advance(now);
+    }
+    for (const auto &timer : timers) {
+        ASSERT_EQ(timer.fire_count_, 1);
+        // Fired by the first advance that reached the deadline.
+        ASSERT_GE(timer.fired_at_, timer.want_);
+        ASSERT_LT(timer.fired_at_, timer.want_ + 5000);
+    }
+}
+
+TEST_F(TEST_NAME, WheelExactTicks) {
+    TimerWheel wheel(1000);
+    std::uint64_t now = 0;
+    std::vector<TestTimer> timers(3);
+    std::uint64_t deadlines[] = {1000, 1255, std::uint64_t{1} << 40};
+    for (int i = 0; i < 3; ++i) {
+        timers[i].deadline_ = deadlines[i];
+        timers[i].now_ = &now;
+        wheel.insert(&timers[i]);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        // The wheel knows when the next timer, or the cascade leading to it, is due.
+        while (timers[i].fire_count_ == 0) {
+            now = wheel.next_event();
+            ASSERT_LE(now, deadlines[i]);
+            wheel.advance(now);
+        }
+        EXPECT_EQ(timers[i].fired_at_, deadlines[i]);
+    }
+    EXPECT_EQ(wheel.next_event(), TimerWheel::kNever);
+}
+
+TEST_F(TEST_NAME, WheelRemove) {
+    TimerWheel wheel;
+    std::uint64_t now = 0;
+    std::vector<TestTimer> timers(100);
+    for (std::size_t i = 0; i < timers.size(); ++i) {
+        timers[i].deadline_ = i * 37;
+        timers[i].now_ = &now;
+        wheel.insert(&timers[i]);
+    }
+    for (std::size_t i = 0; i < timers.size(); i += 2) {
+        wheel.remove(&timers[i]);
+    }
+    EXPECT_EQ(wheel.size(), 50);
+
+    now = 100 * 37;
+    EXPECT_EQ(wheel.advance(now), 50);
+    for (std::size_t i = 0; i < timers.size(); ++i) {
+        EXPECT_EQ(timers[i].fire_count_, i % 2);
+    }
+}
+
+TEST_F(TEST_NAME, WheelReinsertFromCallback) {
+    // Fires every 10 ticks by putting itself back.
+    struct Periodic : TimerNode {
+        Periodic(TimerWheel &wheel) : wheel_(wheel) { fire_ = &on_fire; }
+
+        static void on_fire(TimerNode *node) noexcept {
+            auto *self = static_cast<Periodic *>(node);
+            if (++self->count_ < 100) {
+                self->deadline_ += 10;
+                self->wheel_.insert(self);
+            }
+        }
+
+        TimerWheel &wheel_;
+        int count_ = 0;
+    };
+
+    TimerWheel wheel;
+    Periodic periodic(wheel);
+    periodic.deadline_ = 10;
+    wheel.insert(&periodic);
+    EXPECT_EQ(wheel.advance(995), 99);
+    EXPECT_EQ(wheel.advance(1000), 1);
+    EXPECT_EQ(periodic.count_, 100);
+}
+
+TEST_F(TEST_NAME, SleepFor) {
+    auto body = []() -> Task<TimerService::Clock::duration> {
+        auto start = TimerService::Clock::now();
+        co_await sleep_for(20ms);
+        co_return TimerService::Clock::now() - start;
+    };
+    EXPECT_GE(sync_wait(body()), 20ms);
+
+    auto past = []() -> Task<> {
+        co_await sleep_until(TimerService::Clock::now() - 1s);
+    };
+    sync_wait(past());
+}
+
+TEST_F(TEST_NAME, CancelSleep) {
+    TimerService service;
+    std::stop_source source;
+    auto sleeper = [&]() -> Task<bool> {
+        bool cancelled = false;
+        try {
+            co_await service.sleep_for(10s);
+        } catch (const OperationCancelled &) {
+            cancelled = true;
+        }
+        co_return cancelled;
+    };
+
+    auto task = sleeper();
+    task.set_stop_token(source.get_token());
+    std::jthread stopper([&] {
+        std::this_thread::sleep_for(20ms);
+        source.request_stop();
+    });
+    auto start = TimerService::Clock::now();
+    EXPECT_TRUE(sync_wait(std::move(task)));
+    EXPECT_LT(TimerService::Clock::now() - start, 5s);
+
+    // Stop requested already, the timer is never scheduled.
+    auto stopped = sleeper();
+    stopped.set_stop_token(source.get_token());
+    EXPECT_TRUE(sync_wait(std::move(stopped)));
+}
+
+// No stop token: the timer thread may resume the sleeper, and a detached task's frame be freed,
+// before `co_await` has left `await_suspend` on the spawning thread.
+TEST_F(TEST_NAME, DetachedSleepsWithoutToken) {
+    constexpr int kTasks = 1000;
+    constexpr int kSleeps = 5;
+    TimerService service;
+    std::latch done(kTasks);
+    std::atomic<int> woken = 0;
+    auto sleeper = [](TimerService &service, std::atomic<int> &woken) -> Task<> {
+        for (int i = 0; i < kSleeps; ++i) {
+            co_await service.sleep_for(1us);
+            woken.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+    auto on_done = [](void *context, std::exception_ptr) noexcept {
+        static_cast<std::latch *>(context)->count_down();
+    };
+    for (int i = 0; i < kTasks; ++i) {
+        detail::DetachedTask::start(sleeper(service, woken), on_done, &done);
+    }
+    done.wait();
+    EXPECT_EQ(woken.load(), kTasks * kSleeps);
+}
+
+TEST_F(TEST_NAME, ManyConcurrentSleeps) {
+    TimerService service;
+    auto sleeper = [](TimerService &service, int ms) -> Task<bool> {
+        auto deadline = TimerService::Clock::now() + std::chrono::milliseconds(ms);
+        co_await service.sleep_until(deadline);
+        co_return TimerService::Clock::now() >= deadline;
+    };
+
+    std::mt19937 rng(7);
+    std::vector<Task<bool>> tasks;
+    for (int i = 0; i < 10000; ++i) {
+        tasks.push_back(sleeper(service, static_cast<int>(rng() % 50)));
+    }
+    auto all = [](std::vector<Task<bool>> tasks) -> Task<std::vector<bool>> {
+        co_return co_await when_all(std::move(tasks));
+    };
+    auto results = sync_wait(all(std::move(tasks)));
+    for (bool on_time : results) {
+        ASSERT_TRUE(on_time);
+    }
+}
+} // namespace myx_coroutine
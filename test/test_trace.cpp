@@ -0,0 +1,73 @@
+#include "myx_coroutine/sync_wait.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include "myx_coroutine/trace.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       TraceTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+TEST_F(TEST_NAME, WritesTraceEventObject) {
+    std::ostringstream out;
+    trace::write_chrome_trace(out);
+    std::string json = out.str();
+    EXPECT_THAT(json, testing::StartsWith("{\"traceEvents\":["));
+    EXPECT_THAT(json, testing::EndsWith("]}\n"));
+}
+
+#if MYX_COROUTINE_TRACE
+TEST_F(TEST_NAME, RecordsTaskLifecycleAndPoolJobs) {
+    coroutine::ThreadPool pool(2, coroutine::ThreadPool::Scheduling::WorkStealing);
+    auto child = []() -> Task<int> {
+        co_return 1;
+    };
+    auto parent = [&]() -> Task<int> {
+        co_await pool.schedule();
+        co_return co_await child();
+    };
+    auto task = parent();
+    std::ostringstream promise;
+    promise << static_cast<const void *>(&task.promise());
+    EXPECT_EQ(sync_wait(std::move(task)), 1);
+
+    std::ostringstream out;
+    trace::write_chrome_trace(out);
+    std::string json = out.str();
+    std::string id = "\"id\":\"" + promise.str() + "\"";
+    EXPECT_THAT(json, testing::HasSubstr("\"ph\":\"b\",\"cat\":\"task\",\"name\":\"task\"," + id));
+    EXPECT_THAT(json, testing::HasSubstr("\"ph\":\"e\",\"cat\":\"task\",\"name\":\"task\"," + id));
+    EXPECT_THAT(json, testing::HasSubstr("\"name\":\"await\""));
+    EXPECT_THAT(json, testing::HasSubstr("\"ph\":\"B\",\"name\":\"job\""));
+    EXPECT_THAT(json, testing::HasSubstr("\"ph\":\"E\",\"name\":\"job\""));
+}
+#endif
+} // namespace myx_coroutine
@@ -0,0 +1,224 @@
+#include "myx_coroutine/cancellation.hpp"
+#include "myx_coroutine/sync_wait.hpp"
+#include "myx_coroutine/task.hpp"
+#include "myx_coroutine/thread_pool.hpp"
+#include "myx_coroutine/timer_service.hpp"
+#include "myx_coroutine/when_all.hpp"
+#include "myx_coroutine/when_any.hpp"
+#include <atomic>
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <latch>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace myx_coroutine {
+
+#define ENABLE_TEST_NAME 1
+#define TEST_NAME_       WhenAllTest
+
+#if ENABLE_TEST_NAME
+#define TEST_NAME TEST_NAME_
+#else
+#define TEST_NAME DISABLED_##TEST_NAME_
+#endif
+
+struct TEST_NAME : public testing::Test {
+  protected:
+    void SetUp() override {
+        spdlog::set_pattern(
+            "[%Y-%m-%d %H:%M:%S] " // time
+            "[%^%-5l%$] "          // level
+            "[thread %t] "         // thread
+            "[%s:%#]: "            // file:line
+            "%v"                   // content
+        );
+        SPDLOG_INFO("testing started");
+    }
+
+    void TearDown() override { SPDLOG_INFO("testing finished"); }
+};
+
+using namespace std::chrono_literals;
+using coroutine::ThreadPool;
+
+TEST_F(TEST_NAME, Variadic) {
+    auto number = []() -> Task<int> {
+        co_return 42;
+    };
+    auto text = []() -> Task<std::string> {
+        co_return "hello";
+    };
+    auto nothing = []() -> Task<> {
+        co_return;
+    };
+
+    auto body = [&]() -> Task<int> {
+        auto [a, b, c] = co_await when_all(number(), text(), nothing());
+        EXPECT_EQ(b, "hello");
+        EXPECT_EQ(c, Unit{});
+        co_return a;
+    };
+    auto task = body();
+    task.resume();
+    EXPECT_TRUE(task.is_ready());
+    EXPECT_EQ(task.promise().get_result(), 42);
+}
+
+TEST_F(TEST_NAME, Range) {
+    auto square = [](int i) -> Task<int> {
+        co_return i * i;
+    };
+
+    auto body = [&]() -> Task<int> {
+        std::vector<Task<int>> tasks;
+        for (int i = 0; i < 10; ++i) {
+            tasks.push_back(square(i));
+        }
+        auto results = co_await when_all(std::move(tasks));
+        int sum = 0;
+        for (int value : results) {
+            sum += value;
+        }
+        co_return sum;
+    };
+    auto task = body();
+    task.resume();
+    EXPECT_EQ(task.promise().get_result(), 285);
+}
+
+TEST_F(TEST_NAME, Empty) {
+    auto task = []() -> Task<std::size_t> {
+        auto results = co_await when_all(std::vector<Task<int>>{});
+        co_return results.size();
+    }();
+    task.resume();
+    EXPECT_EQ(task.promise().get_result(), 0);
+}
+
+TEST_F(TEST_NAME, FirstExceptionWins) {
+    auto fail = [](int i) -> Task<int> {
+        throw std::runtime_error(std::to_string(i));
+        co_return i;
+    };
+    auto ok = []() -> Task<int> {
+        co_return 0;
+    };
+
+    auto body = [&]() -> Task<> {
+        co_await when_all(ok(), fail(1), fail(2));
+    };
+    auto task = body();
+    task.resume();
+    try {
+        task.promise().get_result();
+        FAIL() << "expected an exception";
+    } catch (const std::runtime_error &e) {
+        EXPECT_STREQ(e.what(), "1");
+    }
+}
+
+// Children sleeping in parallel on a pool take as long as the slowest, not the sum.
+TEST_F(TEST_NAME, ConcurrentOnPool) {
+    constexpr int count = 8;
+    auto pool = std::make_unique<ThreadPool>(count);
+    auto backend = [](ThreadPool &pool, int i) -> Task<int> {
+        co_await pool.schedule();
+        std::this_thread::sleep_for(50ms);
+        co_return i;
+    };
+
+    std::latch done(1);
+    int sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto body = [&]() -> Task<> {
+        std::vector<Task<int>> tasks;
+        for (int i = 0; i < count; ++i) {
+            tasks.push_back(backend(*pool, i));
+        }
+        for (int value : co_await when_all(std::move(tasks))) {
+            sum += value;
+        }
+        done.count_down();
+    };
+    auto task = body();
+    task.resume();
+    done.wait();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    pool.reset();
+
+    EXPECT_EQ(sum, count * (count - 1) / 2);
+    EXPECT_LT(elapsed, 50ms * count / 2);
+}
+
+TEST_F(TEST_NAME, WhenAnyFirstFinisher) {
+    ThreadPool pool(2);
+    std::latch release(1);
+    std::latch slow_done(1);
+    auto fast = []() -> Task<int> {
+        co_return 1;
+    };
+    auto slow = [&]() -> Task<int> {
+        co_await pool.schedule();
+        release.wait();
+        slow_done.count_down();
+        co_return 2;
+    };
+
+    auto body = [&]() -> Task<WhenAnyResult<int>> {
+        co_return co_await when_any(slow(), fast());
+    };
+    auto task = body();
+    task.resume();
+    EXPECT_TRUE(task.is_ready());
+    auto result = task.promise().get_result();
+    EXPECT_EQ(result.index_, 1);
+    EXPECT_EQ(result.value_, 1);
+
+    // The loser keeps running after the caller moved on.
+    release.count_down();
+    slow_done.wait();
+}
+
+TEST_F(TEST_NAME, WhenAnyCancelsLosers) {
+    TimerService service;
+    std::latch losers_done(2);
+    auto sleeper = [&](std::chrono::milliseconds duration) -> Task<long> {
+        bool cancelled = false;
+        try {
+            co_await service.sleep_for(duration);
+        } catch (const OperationCancelled &) {
+            cancelled = true;
+        }
+        if (cancelled) {
+            losers_done.count_down();
+            co_return -1;
+        }
+        co_return duration.count();
+    };
+
+    auto body = [&]() -> Task<WhenAnyResult<long>> {
+        co_return co_await when_any(sleeper(10s), sleeper(1ms), sleeper(10s));
+    };
+    auto start = std::chrono::steady_clock::now();
+    auto result = sync_wait(body());
+    EXPECT_EQ(result.index_, 1);
+    EXPECT_EQ(result.value_, 1);
+    // Both losers give up instead of sleeping on.
+    losers_done.wait();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST_F(TEST_NAME, WhenAnyNotAwaited) {
+    auto task = []() -> Task<int> {
+        co_return 1;
+    };
+    { auto awaiter = when_any(task(), task()); }
+    EXPECT_THROW(when_any(std::vector<Task<int>>{}), std::invalid_argument);
+}
+} // namespace myx_coroutine